@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 在后台线程中执行 UIAutomator::prewarm，并以 prewarm/progress 通知汇报进度。
+ *
+ * 进度通知至多每 PROGRESS_INTERVAL 发送一次，完成时必定发送一条 finished 为 true 的通知。
+ * 预热期间启动的任务仍可正常运行，只是尚未加载的资源会在首次使用时同步加载。
+ */
+class AssetPrewarmer {
+public:
+    static constexpr std::chrono::milliseconds PROGRESS_INTERVAL{100};
+
+    AssetPrewarmer() = default;
+    ~AssetPrewarmer();
+
+    AssetPrewarmer(const AssetPrewarmer&) = delete;
+    AssetPrewarmer& operator=(const AssetPrewarmer&) = delete;
+
+    /**
+     * @brief 开始预热。
+     * @return 已有预热在进行时返回 false。
+     */
+    bool start();
+
+    /**
+     * @brief 当前进度：{"state": "idle"|"running"|"done", "done", "total", "loaded", "failed", "elapsed_ms"}。
+     */
+    json status() const;
+
+private:
+    enum class State { Idle, Running, Done };
+
+    void run();
+    json statusLocked() const;
+
+    mutable std::mutex mutex_;
+    State state_ = State::Idle;
+    size_t done_ = 0;
+    size_t total_ = 0;
+    size_t loaded_ = 0;
+    size_t failed_ = 0;
+    std::chrono::steady_clock::time_point started_at_{};
+    std::chrono::steady_clock::duration elapsed_{};
+    std::thread thread_;
+};
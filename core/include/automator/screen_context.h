@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <opencv2/core/mat.hpp>
+
+#include <meta/generated_ui.h>
+
+#include "cv/tile_hasher.h"
+
+namespace UIAutomator {
+
+/**
+ * @brief 在连续的截图上反复执行 verify/find 时，复用画面未变化区域的结果。
+ *
+ * 每次截图后调用 update 提交画面，ScreenContext 用 TileHasher 记录各分块最近一次变化的帧：
+ * verify 的区域自上次判断以来没有变化时直接返回上次的结果；
+ * find 上次命中的位置没有变化时沿用该位置，上次未命中时只在变化过的区域附近重新搜索。
+ * 静止的菜单与加载画面因此几乎不再消耗模板匹配的时间。
+ *
+ * 命中与未命中分别计入 automator.cache_hits / automator.cache_misses。
+ * 对象不是线程安全的，应由执行任务的线程独占。
+ */
+class ScreenContext {
+public:
+    /**
+     * @brief 实际执行模板匹配的函数。默认使用 UIAutomator::verify/find，
+     * 测试可以替换为记录调用的实现，不依赖资源文件与 Win32。
+     */
+    struct Matcher {
+        std::function<bool(const cv::Mat& screen, const UILayouts::Metadata& layout, double confidence)> verify;
+        // 只在 screen 的 search 区域内查找，返回 screen 坐标系下的位置
+        std::function<std::optional<cv::Rect>(const cv::Mat& screen, const cv::Rect& search,
+            const UITemplates::Metadata& template_, double confidence)> find;
+        // 模板尺寸，模板无法加载时为空
+        std::function<cv::Size(const UITemplates::Metadata& template_)> template_size;
+    };
+
+    /**
+     * @brief 使用 UIAutomator 的模板匹配，定义在 ui_automator.cpp。
+     */
+    explicit ScreenContext(int tile_size = TileHasher::DEFAULT_TILE_SIZE);
+
+    explicit ScreenContext(Matcher matcher, int tile_size = TileHasher::DEFAULT_TILE_SIZE);
+
+    /**
+     * @brief 提交新的截图，之后的 verify/find 都针对这一帧。screen 只保存引用，不拷贝像素。
+     */
+    void update(const cv::Mat& screen);
+
+    const cv::Mat& screen() const { return screen_; }
+    const TileHasher& tiles() const { return tiles_; }
+
+    bool verify(const UILayouts::Metadata& layout, double confidence = 0.9);
+
+    std::optional<cv::Rect> find(const UITemplates::Metadata& template_, double confidence = 0.9);
+
+    /**
+     * @brief 丢弃所有缓存的结果，例如资源重新加载之后。
+     */
+    void clear();
+
+private:
+    struct CachedResult {
+        uint64_t frame = 0;  // 得出结果时的帧序号
+        double confidence = 0.0;
+        std::optional<cv::Rect> location;
+    };
+
+    Matcher matcher_;
+    cv::Mat screen_;
+    TileHasher tiles_;
+    std::unordered_map<std::string, CachedResult> layouts_;
+    std::unordered_map<std::string, CachedResult> templates_;
+};
+
+} // namespace UIAutomator
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <optional>
 
 #include <opencv2/core/mat.hpp>
@@ -7,23 +9,29 @@
 
 #include <meta/generated_ui.h>
 
+#include "automator/screen_context.h"
 #include "io/mouse_handler.h"
 
 namespace UIAutomator {
 
-inline void click_in_rect(const cv::Rect& target_rect, IOBackend::Mode backend = IOBackend::Mode::WindowMessage, bool instant_move = true) {
-    MouseHandler::click_in_rect_with_backend(target_rect, backend, instant_move);
-}
+/**
+ * @brief 点击与拖动记到当前线程最近一次截图的帧上（FrameTrace::lastCaptured），
+ * 调用方已经绑定了自己的 FrameTrace 时沿用调用方的绑定。
+ */
+void click_in_rect(const cv::Rect& target_rect, IOBackend::Mode backend = IOBackend::Mode::WindowMessage, bool instant_move = true);
 
-inline void drag(
+void drag(
     const cv::Rect& start_rect,
     const cv::Rect& end_rect,
     IOBackend::Mode backend = IOBackend::Mode::WindowMessage,
     bool instant_move = false
-) {
-    MouseHandler::drag_with_backend(start_rect, end_rect, backend, instant_move);
-}
+);
 
+/**
+ * @brief 以下函数的 screen 可以是 BGR（CV_8UC3）或 Screenshot::capture_bgra 返回的 BGRA（CV_8UC4）。
+ * 模板在首次加载时解码为 BGR 并缓存；BGRA 画面只有参与比较的区域被转换：
+ * verify 只转换布局所在的区域，find 只转换搜索区域。
+ */
 bool verify(const cv::Mat& screen, const UILayouts::Metadata& layout, double confidence = 0.9);
 
 bool verify_click(
@@ -34,14 +42,38 @@ bool verify_click(
     bool instant_move = true
 );
 
-std::optional<cv::Rect> find(const cv::Mat& screen, const UITemplates::Metadata& template_, double confidence = 0.9);
+/**
+ * @param search 只在画面的这一区域内查找，空矩形表示整个画面。返回的位置仍为整个画面的坐标。
+ */
+std::optional<cv::Rect> find(
+    const cv::Mat& screen,
+    const UITemplates::Metadata& template_,
+    double confidence = 0.9,
+    const cv::Rect& search = cv::Rect()
+);
 
 bool find_click(
     const cv::Mat& screen,
     const UITemplates::Metadata& template_,
     double confidence = 0.9,
     IOBackend::Mode backend = IOBackend::Mode::WindowMessage,
-    bool instant_move = true
+    bool instant_move = true,
+    const cv::Rect& search = cv::Rect()
 );
 
+struct PrewarmResult {
+    size_t total = 0;
+    size_t loaded = 0;
+    size_t failed = 0;
+};
+
+// done 为已处理的资源数（含失败），name 为刚处理完的资源名
+using PrewarmCallback = std::function<void(size_t done, size_t total, const char* name, bool ok)>;
+
+/**
+ * @brief 预先加载并预处理所有生成的 UILayouts/UITemplates 资源，并初始化特征匹配器。
+ * 完成后 verify/find 只会命中缓存。可以在后台线程调用，与任务并发执行是安全的。
+ */
+PrewarmResult prewarm(const PrewarmCallback& on_progress = nullptr);
+
 } // namespace UIAutomator
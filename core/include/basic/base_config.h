@@ -11,4 +11,7 @@ namespace BaseConfig {
     // 游戏UI模板
     inline const char* ASSETS_TEMPLATES_PATH = "assets/templates";
 
+    // 服务启动时是否在后台预热全部UI资源（也可由客户端调用 app/prewarm 触发）
+    inline const bool PREWARM_ON_STARTUP = true;
+
 }
@@ -2,11 +2,15 @@
 
 #include <string>
 #include <memory>
+#include <functional>
 #include "nlohmann/json.hpp"
 #include "logger.h"
 
 using json = nlohmann::json;
 
+class StatusPublisher;
+class TaskExecutor;
+
 class BaseTask {
 public:
     virtual ~BaseTask() = default;
@@ -16,4 +20,20 @@ public:
     virtual void stop() = 0;
     virtual bool isRunning() const = 0;
     virtual json getStatus() const = 0;
+
+    /**
+     * @brief 设置状态变更的推送目标。默认实现不推送，客户端只能轮询 getStatus。
+     */
+    virtual void setStatusPublisher(std::shared_ptr<StatusPublisher> publisher) { (void)publisher; }
+
+    /**
+     * @brief 设置任务结束（完成、失败或取消）时的回调，在任务线程上、isRunning 变为 false 之后调用。
+     * 必须在 start 之前设置。
+     */
+    virtual void setFinishedCallback(std::function<void()> callback) = 0;
+
+    /**
+     * @brief 设置执行任务体的常驻线程池。默认实现忽略，任务自行管理线程。
+     */
+    virtual void setExecutor(std::shared_ptr<TaskExecutor> executor) { (void)executor; }
 };
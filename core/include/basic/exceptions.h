@@ -14,3 +14,27 @@ public:
     explicit WindowException(const std::string& message)
         : std::runtime_error("重置窗口失败: " + message) {}
 };
+
+class SharedMemoryException : public std::runtime_error {
+public:
+    explicit SharedMemoryException(const std::string& message)
+        : std::runtime_error("共享内存错误: " + message) {}
+};
+
+class RpcException : public std::runtime_error {
+public:
+    explicit RpcException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+class FrameSourceException : public std::runtime_error {
+public:
+    explicit FrameSourceException(const std::string& message)
+        : std::runtime_error("帧源错误: " + message) {}
+};
+
+class FlightRecordException : public std::runtime_error {
+public:
+    explicit FlightRecordException(const std::string& message)
+        : std::runtime_error("飞行记录错误: " + message) {}
+};
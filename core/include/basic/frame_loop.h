@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "basic/metrics.h"
+#include "basic/stop_token.h"
+
+/**
+ * @brief 固定帧率的实时循环驱动。
+ *
+ * 每帧的计划开始时间按 上一计划时间 + 周期 推进，而不是 本帧结束时间 + 周期，
+ * 因此单帧的处理耗时不会累积成漂移。落后不足一个周期时下一帧立即开始以追上节奏；
+ * 落后超过一个周期时跳过错过的时隙，不连续补帧。
+ *
+ * 等待使用 StopToken，停止请求会立即打断；临近计划时间的最后 spin_margin 改为忙等，
+ * 弥补系统定时器的精度不足。
+ *
+ * 指标（前缀由构造参数给出，直方图单位为微秒）：
+ *   <prefix>.interval         相邻两帧实际开始时间的间隔
+ *   <prefix>.jitter           实际开始时间相对计划时间的延迟
+ *   <prefix>.deadline_misses  处理结束晚于本帧截止时间（计划时间 + 周期）的帧数
+ *   <prefix>.skipped_frames   因严重落后而跳过的时隙数
+ */
+class FrameLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        double target_hz = 60.0;  // 不大于 0 时不限速：上一帧处理完立即开始下一帧，不统计超时
+        std::chrono::microseconds spin_margin{500};
+    };
+
+    struct Frame {
+        uint64_t index;                // 从 0 开始的帧序号
+        Clock::time_point scheduled;   // 计划开始时间
+        Clock::time_point started;     // 实际开始时间
+        Clock::duration interval;      // 距上一帧实际开始的间隔，首帧与退避后的第一帧为 0
+    };
+
+    /**
+     * @brief 每帧回调的返回值。
+     */
+    class Action {
+    public:
+        enum class Kind { Next, Backoff, Stop };
+
+        static Action next() { return Action(Kind::Next); }
+        /**
+         * @brief 暂停指定时长后重新对齐节奏，例如窗口暂不可用时。退避期间不计入超时统计。
+         */
+        static Action backoff(Clock::duration delay) { return Action(Kind::Backoff, delay); }
+        static Action stop() { return Action(Kind::Stop); }
+
+        Kind kind() const { return kind_; }
+        Clock::duration delay() const { return delay_; }
+
+    private:
+        explicit Action(Kind kind, Clock::duration delay = {}) : kind_(kind), delay_(delay) {}
+
+        Kind kind_;
+        Clock::duration delay_;
+    };
+
+    using FrameCallback = std::function<Action(const Frame&)>;
+
+    FrameLoop(StopToken& stop_token, const std::string& metrics_prefix);
+    FrameLoop(StopToken& stop_token, const std::string& metrics_prefix, Options options);
+
+    /**
+     * @brief 运行循环，直到回调返回 stop 或收到停止请求。
+     */
+    void run(const FrameCallback& on_frame);
+
+    Clock::duration period() const { return period_; }
+
+private:
+    /**
+     * @brief 等待到指定时间点。
+     * @return 收到停止请求时返回 false。
+     */
+    bool waitUntil(Clock::time_point deadline);
+
+    StopToken& stop_token_;
+    const Options options_;
+    const Clock::duration period_;
+
+    LatencyHistogram& interval_latency_;
+    LatencyHistogram& jitter_latency_;
+    Metrics::Counter& deadline_misses_;
+    Metrics::Counter& skipped_frames_;
+};
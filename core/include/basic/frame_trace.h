@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 一帧从截图到输入发出的时间线，随帧在流水线各阶段之间按值传递。
+ *
+ * 起点是截图开始的时刻，即像素被读取的最早时间；各阶段结束时调用 mark。
+ * Screenshot 的每次截图都通过 captured 分配帧序号并记为当前线程最近一次截图，
+ * 没有自己流水线的调用方（UIAutomator 的点击）据此把输入动作记到画面所属的帧。
+ * 输入模块发出动作后调用 inputInjected，若当前线程通过 Binding 绑定了触发该动作的帧，
+ * 则标记 INJECT 并把各段耗时记录到直方图（单位微秒）：
+ *   e2e.capture / .convert / .detect / .decide / .inject  各阶段耗时
+ *   e2e.total                                           截图开始到输入发出
+ *   e2e.untagged_inputs                                 没有绑定帧的输入动作数
+ * 每段从上一阶段结束算起，包含在阶段之间排队等待的时间，各段之和等于 e2e.total；
+ * 没有标记的阶段计为 0，其时间并入下一个标记的阶段。
+ */
+class FrameTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Stage {
+        CAPTURE = 0,  // 截图完成
+        CONVERT,      // 颜色转换等预处理完成
+        DETECT,       // 识别完成
+        DECIDE,       // 决定发出输入
+        INJECT,       // 输入已发出
+        STAGE_COUNT,
+    };
+
+    FrameTrace() = default;
+    FrameTrace(uint64_t frame_id, Clock::time_point captured_at) : frame_id_(frame_id), captured_at_(captured_at) {}
+
+    bool valid() const { return captured_at_ != Clock::time_point{}; }
+    uint64_t frameId() const { return frame_id_; }
+    Clock::time_point capturedAt() const { return captured_at_; }
+
+    void mark(Stage stage, Clock::time_point at = Clock::now()) { marks_[stage] = at; }
+
+    /**
+     * @brief 阶段的结束时刻，未标记时为 Clock::time_point{}。
+     */
+    Clock::time_point markedAt(Stage stage) const { return marks_[stage]; }
+
+    /**
+     * @brief 把各阶段耗时与端到端延迟记录到 e2e.* 直方图，无效的时间线不记录。
+     */
+    void record() const;
+
+    /**
+     * @brief 在作用域内把帧绑定到当前线程，期间发出的输入动作都记到这一帧。
+     */
+    class Binding {
+    public:
+        explicit Binding(FrameTrace& trace) : previous_(current_) { current_ = &trace; }
+        ~Binding() { current_ = previous_; }
+
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+
+    private:
+        FrameTrace* previous_;
+    };
+
+    /**
+     * @brief 当前线程绑定的帧序号，未绑定时返回 0。
+     */
+    static uint64_t currentFrameId() { return current_ ? current_->frameId() : 0; }
+
+    /**
+     * @brief 当前线程是否已经绑定了帧。
+     */
+    static bool bound() { return current_ != nullptr; }
+
+    /**
+     * @brief 取得一帧画面后调用：分配全局递增的帧序号（从 1 开始），
+     * 以 started_at 为起点并标记 CAPTURE，同时记为当前线程最近一次截图。
+     * Screenshot 的各截图路径自动调用；不经过 Screenshot 读取录制画面的任务自行调用。
+     */
+    static FrameTrace captured(Clock::time_point started_at);
+
+    /**
+     * @brief 当前线程最近一次截图的时间线，尚未截图时无效。
+     */
+    static const FrameTrace& lastCaptured() { return last_captured_; }
+
+    /**
+     * @brief 由输入模块在动作发出后调用。只记录绑定的帧触发的第一个动作，
+     * 同一帧之后的动作（例如拖动的后半段）不重复计入。
+     * @return 触发该动作的帧序号；当前线程没有绑定帧时返回 0 并计入 e2e.untagged_inputs。
+     */
+    static uint64_t inputInjected();
+
+private:
+    uint64_t frame_id_ = 0;
+    Clock::time_point captured_at_{};
+    std::array<Clock::time_point, STAGE_COUNT> marks_{};
+
+    static inline thread_local FrameTrace* current_ = nullptr;
+    static thread_local FrameTrace last_captured_;
+    static inline std::atomic<uint64_t> next_frame_id_{1};
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "nlohmann/json.hpp"
+#include "basic/rpc_encoding.h"
+#include <istream>
 #include <string>
 #include <optional>
 
@@ -13,7 +15,9 @@ using json = nlohmann::json;
  * 1. 请求/响应 (Request/Response): 回复客户端的特定请求（成功或失败）。
  * 2. 通知 (Notification): 向客户端主动推送分类的异步消息。
  *
- * 所有消息都通过 stdout 发送。
+ * 所有消息都通过 stdout 发送：调用方只负责序列化并入队，由 RpcWriter 的专用线程批量写出。
+ * 通道默认使用换行分隔的文本 JSON，客户端可通过 app/setEncoding 协商切换为
+ * 带长度前缀的 CBOR 或 MessagePack（见 RpcEncoding）。
  */
 class JsonRpc {
 public:
@@ -22,25 +26,54 @@ public:
     //=========================================================================
 
     /**
-     * @brief 解析输入的字符串，验证其是否为有效的JSON-RPC请求。
-     * @param line 从 stdin 读取的一行字符串。
-     * @return 如果是有效请求，则返回包含该请求json的optional。
-     *         如果是无效JSON或无效请求，则自动发送错误响应并返回std::nullopt。
+     * @brief 按当前通道编码从输入流读取一条完整消息。
+     * @param in 输入流，通常为 stdin。
+     * @param message 读取到的消息负载（文本编码下为一行，二进制编码下不含长度前缀）。
+     * @return 输入流结束、出错或帧长度非法时返回 false。
      */
-    static std::optional<json> parseRequest(const std::string& line);
+    static bool readMessage(std::istream& in, std::string& message);
 
     /**
-     * @brief 发送一个成功的 JSON-RPC 2.0 响应。
+     * @brief 解码输入的消息。
+     * @param line 由 readMessage 读取的一条消息。
+     * @return 解码成功时返回单个请求对象或批量请求数组，尚未校验其中的请求。
+     *         如果消息无法解码或为空的批量数组，则自动发送错误响应并返回std::nullopt。
+     */
+    static std::optional<json> parseMessage(const std::string& line);
+
+    /**
+     * @brief 校验单个请求对象是否符合 JSON-RPC 2.0 规范。
+     * @return 有效时返回std::nullopt，否则返回对应的错误响应（不会自动发送）。
+     */
+    static std::optional<json> validateRequest(const json& request);
+
+    /**
+     * @brief 构造一个成功的 JSON-RPC 2.0 响应。
      * @param request 客户端的原始请求对象，用于提取 'id'。
      * @param result  包含成功结果的数据，将被封装在响应的 'result' 字段中。
      */
-    static void sendSuccessResponse(const json& request, const json& result);
+    static json successResponse(const json& request, const json& result);
 
     /**
-     * @brief 发送一个错误的 JSON-RPC 2.0 响应。
+     * @brief 构造一个错误的 JSON-RPC 2.0 响应。
      * @param request 客户端的原始请求对象，用于提取 'id'。
      * @param error_message 描述性的错误信息。
      */
+    static json errorResponse(const json& request, const std::string& error_message);
+
+    /**
+     * @brief 发送一个已构造好的响应对象，或批量请求对应的响应数组。
+     */
+    static void sendResponse(const json& response);
+
+    /**
+     * @brief 发送一个成功的 JSON-RPC 2.0 响应。
+     */
+    static void sendSuccessResponse(const json& request, const json& result);
+
+    /**
+     * @brief 发送一个错误的 JSON-RPC 2.0 响应。
+     */
     static void sendErrorResponse(const json& request, const std::string& error_message);
 
 
@@ -72,6 +105,25 @@ public:
      */
     static void sendError(const std::string& method, const std::string& message, const std::optional<json>& payload = std::nullopt);
 
+    /**
+     * @brief 发送一条不带级别与消息的通知，params 原样作为通知参数。
+     * @param method 通知的方法名 (例如 "task/status")。
+     */
+    static void sendNotification(const std::string& method, const json& params);
+
+    /**
+     * @brief 阻塞直到此前发送的所有消息都已写入 stdout。
+     */
+    static void flush();
+
+    /**
+     * @brief 切换通道编码，同时作用于之后读取的请求和发送的消息。
+     * 调用前已发送的消息（例如协商请求本身的响应）仍使用旧编码写出。
+     */
+    static void setEncoding(RpcEncoding::Mode mode);
+
+    static RpcEncoding::Mode encoding();
+
     enum class MessageLevel { Info, Warn, Error };
 
 private:
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 线程安全的对数-线性（HDR 风格）延迟直方图，单位为微秒。
+ *
+ * 每个 2 的幂区间被等分为 SUB_BUCKET_HALF 个桶，相对误差约 3%，可记录 1us 到约 12 天的数值。
+ * record 只包含几次无锁原子操作，可以在热路径上调用；分位数在读取时由桶计数估算。
+ */
+class LatencyHistogram {
+public:
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t min_us = 0;
+        uint64_t max_us = 0;
+        double mean_us = 0.0;
+        uint64_t p50_us = 0;
+        uint64_t p95_us = 0;
+        uint64_t p99_us = 0;
+    };
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void recordMicros(uint64_t micros);
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> duration) {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        recordMicros(micros > 0 ? static_cast<uint64_t>(micros) : 0);
+    }
+
+    /**
+     * @brief 估算给定分位（0-100）的数值，返回所在桶的上界。
+     */
+    uint64_t percentile(double percent) const;
+
+    Snapshot snapshot() const;
+
+    /**
+     * @brief 以 JSON 形式导出统计摘要，字段均以 _us 结尾。
+     */
+    json summary() const;
+
+    void reset();
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+    static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+    static constexpr int MAX_VALUE_BITS = 40;
+    static constexpr uint64_t MAX_VALUE = (1ull << MAX_VALUE_BITS) - 1;
+    static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+};
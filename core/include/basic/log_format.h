@@ -0,0 +1,124 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 延迟格式化日志使用的编译期工具。
+ *
+ * 格式串只支持 "{}" 占位符，按顺序替换为参数。参数在调用线程上按值捕获，
+ * 真正的格式化在 RpcWriter 的写线程上完成。
+ * 支持的参数类型：整数、浮点、bool、char、枚举（输出其整数值）以及任何可转换为 std::string_view 的字符串；
+ * 字符串参数会被复制为 std::string，短字符串不会触发堆分配。
+ */
+namespace LogFormat {
+
+constexpr size_t placeholderCount(std::string_view format) {
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < format.size(); ++i) {
+        if (format[i] == '{' && format[i + 1] == '}') {
+            ++count;
+            ++i;
+        }
+    }
+    return count;
+}
+
+template <typename... Args>
+struct Pack {
+    static constexpr size_t size = sizeof...(Args);
+};
+
+// 仅用于 decltype 中统计宏参数的个数，无需定义
+template <typename... Args>
+Pack<Args...> argPack(const Args&...);
+
+// 字符串一律按值复制，避免写线程读取时原缓冲已失效
+template <typename T>
+using Stored = std::conditional_t<
+    std::is_convertible_v<const std::decay_t<T>&, std::string_view> && !std::is_arithmetic_v<std::decay_t<T>>,
+    std::string,
+    std::decay_t<T>>;
+
+inline void appendArg(std::string& out, std::string_view value) {
+    out.append(value);
+}
+
+inline void appendArg(std::string& out, bool value) {
+    out.append(value ? "true" : "false");
+}
+
+inline void appendArg(std::string& out, char value) {
+    out.push_back(value);
+}
+
+template <typename T>
+std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>> appendArg(std::string& out, T value) {
+    if constexpr (std::is_enum_v<T>) {
+        appendArg(out, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+}
+
+template <typename T>
+std::enable_if_t<std::is_floating_point_v<T>> appendArg(std::string& out, T value) {
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value));
+    if (length > 0) {
+        out.append(buffer, static_cast<size_t>(length) < sizeof(buffer) ? static_cast<size_t>(length) : sizeof(buffer) - 1);
+    }
+}
+
+// 追加 pos 之后、下一个占位符之前的文本，并把 pos 移到占位符之后
+inline void appendUntilPlaceholder(std::string& out, std::string_view format, size_t& pos) {
+    const size_t next = format.find("{}", pos);
+    if (next == std::string_view::npos) {
+        out.append(format.substr(pos));
+        pos = format.size();
+        return;
+    }
+    out.append(format.substr(pos, next - pos));
+    pos = next + 2;
+}
+
+template <typename Tuple, size_t... I>
+void renderTuple(std::string& out, std::string_view format, const Tuple& args, std::index_sequence<I...>) {
+    size_t pos = 0;
+    ((appendUntilPlaceholder(out, format, pos), appendArg(out, std::get<I>(args))), ...);
+    if (pos < format.size()) {
+        out.append(format.substr(pos));
+    }
+}
+
+/**
+ * @brief 把格式串与参数渲染为文本。
+ */
+template <typename... Args>
+void formatInto(std::string& out, std::string_view format, const Args&... args) {
+    renderTuple(out, format, std::forward_as_tuple(args...), std::index_sequence_for<Args...>{});
+}
+
+/**
+ * @brief 写线程上渲染类型擦除后的参数包。
+ */
+template <typename Tuple>
+void renderStored(std::string& out, const char* format, const void* storage) {
+    renderTuple(out, format, *static_cast<const Tuple*>(storage),
+                std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+}
+
+template <typename Tuple>
+void destroyStored(void* storage) {
+    static_cast<Tuple*>(storage)->~Tuple();
+}
+
+} // namespace LogFormat
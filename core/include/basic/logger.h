@@ -1,19 +1,182 @@
 #pragma once
 
-#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include "nlohmann/json.hpp"
+#include "basic/log_format.h"
 
 using json = nlohmann::json;
 
+struct LogRecord;
+
+/**
+ * @brief 任务日志。
+ *
+ * 每条日志写入一个从预分配池中取出的定长记录，直接挂入 RpcWriter 的队列，
+ * JSON 序列化推迟到写线程上完成，调用线程上没有堆分配。
+ * 最低级别与启用的分类可在运行时通过 app/setLogLevel 调整，被过滤的日志在任何格式化之前即被丢弃。
+ *
+ * 热路径请使用文件末尾的 LOG_* 宏：参数按值捕获，格式化推迟到写线程完成，
+ * 占位符与参数个数在编译期校验，LOG_THROTTLED 还为每个调用点提供独立的限流。
+ */
 class Logger {
+public:
+    enum class Level : uint8_t {
+        Debug = 0,
+        Info = 1,
+        Warn = 2,
+        Error = 3,
+        Off = 4
+    };
+
+    // 日志分类，可按位组合为启用掩码
+    enum class Category : uint32_t {
+        General = 1u << 0,
+        Workflow = 1u << 1,
+        Capture = 1u << 2,
+        Vision = 1u << 3,
+        Input = 1u << 4
+    };
+
+    static constexpr uint32_t ALL_CATEGORIES = (1u << 5) - 1;
+
+    static void setMinLevel(Level level);
+    static Level minLevel();
+
+    static void setCategoryMask(uint32_t mask);
+    static uint32_t categoryMask();
+
+    static bool isEnabled(Level level) {
+        return level >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    static bool isEnabled(Level level, Category category) {
+        return isEnabled(level) &&
+               (category_mask_.load(std::memory_order_relaxed) & static_cast<uint32_t>(category)) != 0;
+    }
+
+    static const char* levelToString(Level level);
+    static std::optional<Level> levelFromString(std::string_view name);
+
+    static const char* categoryToString(Category category);
+    static std::optional<Category> categoryFromString(std::string_view name);
+
+    /**
+     * @brief 日志池的使用情况：池容量与池耗尽时退化为堆分配的次数。
+     */
+    static json poolStats();
+
+    void debug(std::string_view message) const;
+    void info(std::string_view message) const;
+    void warn(std::string_view message) const;
+    void error(std::string_view message) const;
+    void log(Level level, std::string_view message) const;
+
+    /**
+     * @brief 延迟格式化的日志，一般通过 LOG_* 宏调用。
+     * @param format 必须是字符串字面量，写线程格式化时仍会读取它。
+     * @param suppressed 限流期间被丢弃的条数，大于 0 时附加在正文之后。
+     */
+    template <typename... Args>
+    void logf(Level level, Category category, uint32_t suppressed, const char* format, Args&&... args) const {
+        if (level == Level::Off || !isEnabled(level, category)) {
+            return;
+        }
+        using Tuple = std::tuple<LogFormat::Stored<Args>...>;
+        if constexpr (sizeof(Tuple) <= DEFERRED_ARGS_CAPACITY && alignof(Tuple) <= alignof(std::max_align_t)) {
+            void* storage = nullptr;
+            LogRecord* record = acquireDeferred(level, suppressed, format,
+                &LogFormat::renderStored<Tuple>, &LogFormat::destroyStored<Tuple>, &storage);
+            new (storage) Tuple(std::forward<Args>(args)...);
+            submitDeferred(record);
+        } else {
+            // 参数过大放不进定长记录，退化为在调用线程上格式化
+            std::string text;
+            LogFormat::formatInto(text, format, args...);
+            appendSuppressed(text, suppressed);
+            log(level, text);
+        }
+    }
+
+    /**
+     * @brief 发送一条结构化事件通知（不属于日志），type 将作为通知的方法名。
+     */
+    void notify(const std::string& type, const json& payload) const;
+
 private:
-    std::function<void(const json&)> sender_;
+    friend struct LogRecord;
+
+    using RenderFn = void (*)(std::string& out, const char* format, const void* storage);
+    using DestroyFn = void (*)(void* storage);
+
+    // 定长记录中用于保存捕获参数的字节数
+    static constexpr size_t DEFERRED_ARGS_CAPACITY = 192;
+
+    static LogRecord* acquireDeferred(Level level, uint32_t suppressed, const char* format,
+                                      RenderFn render, DestroyFn destroy, void** storage);
+    static void submitDeferred(LogRecord* record);
+    static void appendSuppressed(std::string& text, uint32_t suppressed);
+
+    static inline std::atomic<Level> min_level_{Level::Info};
+    static inline std::atomic<uint32_t> category_mask_{ALL_CATEGORIES};
+};
 
+/**
+ * @brief 单个调用点的限流器：每个时间窗口最多放行一条，并记录期间被丢弃的条数。
+ */
+class LogRateLimiter {
 public:
-    explicit Logger(std::function<void(const json&)> sender);
+    explicit LogRateLimiter(uint32_t interval_ms);
+
+    /**
+     * @return 本次放行时返回 true，suppressed 为上次放行以来被丢弃的条数。
+     */
+    bool allow(uint32_t& suppressed);
 
-    void info(const std::string& message) const;
-    void warn(const std::string& message) const;
-    void error(const std::string& message) const;
+private:
+    const int64_t interval_us_;
+    std::atomic<int64_t> next_allowed_us_{0};
+    std::atomic<uint32_t> suppressed_{0};
 };
+
+// "" fmt "" 保证格式串是字面量；参数个数通过 decltype 在编译期统计，不会求值
+#define LOG_AT(logger, level, category, fmt, ...)                                                   \
+    do {                                                                                            \
+        static_assert(LogFormat::placeholderCount("" fmt "") ==                                     \
+                          decltype(LogFormat::argPack(__VA_ARGS__))::size,                          \
+                      "日志格式串中 {} 的数量与参数个数不一致");                                    \
+        if (Logger::isEnabled((level), (category))) {                                               \
+            (logger).logf((level), (category), 0, "" fmt "", ##__VA_ARGS__);                        \
+        }                                                                                           \
+    } while (0)
+
+#define LOG_DEBUG(logger, category, fmt, ...) \
+    LOG_AT(logger, Logger::Level::Debug, Logger::Category::category, fmt, ##__VA_ARGS__)
+#define LOG_INFO(logger, category, fmt, ...) \
+    LOG_AT(logger, Logger::Level::Info, Logger::Category::category, fmt, ##__VA_ARGS__)
+#define LOG_WARN(logger, category, fmt, ...) \
+    LOG_AT(logger, Logger::Level::Warn, Logger::Category::category, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(logger, category, fmt, ...) \
+    LOG_AT(logger, Logger::Level::Error, Logger::Category::category, fmt, ##__VA_ARGS__)
+
+// 每个调用点拥有独立的限流器，interval_ms 内最多输出一条，下一条会附带被丢弃的条数
+#define LOG_THROTTLED(logger, level, category, interval_ms, fmt, ...)                               \
+    do {                                                                                            \
+        static_assert(LogFormat::placeholderCount("" fmt "") ==                                     \
+                          decltype(LogFormat::argPack(__VA_ARGS__))::size,                          \
+                      "日志格式串中 {} 的数量与参数个数不一致");                                    \
+        if (Logger::isEnabled(Logger::Level::level, Logger::Category::category)) {                  \
+            static LogRateLimiter log_rate_limiter_(interval_ms);                                   \
+            uint32_t log_suppressed_ = 0;                                                           \
+            if (log_rate_limiter_.allow(log_suppressed_)) {                                         \
+                (logger).logf(Logger::Level::level, Logger::Category::category, log_suppressed_,    \
+                              "" fmt "", ##__VA_ARGS__);                                            \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
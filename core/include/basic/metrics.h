@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "nlohmann/json.hpp"
+#include "basic/latency_histogram.h"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 进程级的运行指标注册表，包含计数器、仪表与延迟直方图。
+ *
+ * 指标在首次使用时按名称注册，返回的引用在进程生命周期内保持有效。
+ * 热路径应把引用缓存在函数内的静态变量中，此后记录只涉及无锁原子操作：
+ *   static auto& latency = Metrics::instance().histogram("capture.win32");
+ *   ScopedLatency timer(latency);
+ * 指标名使用 "子系统.指标" 的形式，直方图的单位统一为微秒。
+ */
+class Metrics {
+public:
+    class Counter {
+    public:
+        void add(uint64_t delta = 1) { value_.fetch_add(delta, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+        void reset() { value_.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    class Gauge {
+    public:
+        void set(double value) { value_.store(value, std::memory_order_relaxed); }
+        double value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> value_{0.0};
+    };
+
+    static Metrics& instance();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    Counter& counter(const std::string& name);
+    Gauge& gauge(const std::string& name);
+    LatencyHistogram& histogram(const std::string& name);
+
+    /**
+     * @brief 导出所有指标：{"uptime_ms", "counters", "gauges", "histograms"}。
+     */
+    json snapshot() const;
+
+    /**
+     * @brief 清零计数器与直方图，仪表保持当前值。
+     */
+    void reset();
+
+private:
+    Metrics();
+
+    mutable std::mutex mutex_;  // 只保护注册，不保护指标本身
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;
+    const std::chrono::steady_clock::time_point created_at_;
+};
+
+/**
+ * @brief 作用域计时器，析构时把经过的时间记录到直方图。
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedLatency() {
+        histogram_.record(std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    const std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief 以固定间隔推送 metrics/snapshot 通知的后台线程。
+ */
+class MetricsStreamer {
+public:
+    static constexpr std::chrono::milliseconds MIN_INTERVAL{100};
+
+    MetricsStreamer() = default;
+    ~MetricsStreamer();
+
+    MetricsStreamer(const MetricsStreamer&) = delete;
+    MetricsStreamer& operator=(const MetricsStreamer&) = delete;
+
+    /**
+     * @brief 开始或调整推送，间隔小于 MIN_INTERVAL 时按 MIN_INTERVAL 处理。
+     * 推送中调整间隔时立即生效，下一次推送按新间隔从上一次推送的时刻起算。
+     * start 与 stop 可以从多个线程调用，调用之间互相串行。
+     * @return 实际生效的间隔。
+     */
+    std::chrono::milliseconds start(std::chrono::milliseconds interval);
+    void stop();
+
+private:
+    void streamLoop();
+
+    std::mutex control_mutex_;  // 串行化 start/stop，保护 thread_ 的创建与 join
+    std::mutex mutex_;          // 保护推送线程读取的状态
+    std::condition_variable cv_;
+    std::chrono::milliseconds interval_{0};
+    bool running_ = false;
+    std::thread thread_;
+};
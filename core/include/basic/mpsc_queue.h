@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * @brief 侵入式 MPSC 队列的节点基类。需要入队的消息类型应继承此结构。
+ */
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+/**
+ * @brief 无锁的多生产者/单消费者侵入式队列 (Vyukov 算法)。
+ *
+ * push 可在任意线程调用，只包含一次原子交换和一次原子写入，不会阻塞；
+ * pop 与 empty 只能由唯一的消费者线程调用。
+ * 队列不拥有节点，节点的分配与释放由使用者负责。
+ */
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief 取出一个节点。
+     * @return 队列为空（或生产者尚未完成链接）时返回 nullptr。
+     */
+    MpscNode* pop() {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+
+        if (tail != head_.load(std::memory_order_acquire)) {
+            // 某个生产者已交换 head_ 但还未写入 next，稍后再取
+            return nullptr;
+        }
+
+        push(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    bool empty() const {
+        return tail_ == &stub_ && stub_.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    std::atomic<MpscNode*> head_;
+    MpscNode* tail_;
+    MpscNode stub_;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 任务运行期间占用的资源，按位组合后写入 TaskDescriptor。
+ */
+enum TaskResource : uint32_t {
+    RESOURCE_NONE = 0,
+    RESOURCE_INPUT = 1u << 0,       // 键盘与鼠标输入，独占
+    RESOURCE_FOREGROUND = 1u << 1,  // 游戏窗口的前台状态与尺寸，独占
+    RESOURCE_CAPTURE = 1u << 2,     // 截图，只读，可共享
+};
+
+/**
+ * @brief 任务资源的分配表，由 TaskManager 在启动任务前申请、任务结束后释放。
+ *
+ * 独占资源同一时刻只能由一个任务持有；共享资源只做登记，不会产生冲突。
+ * 因此只读的观察类任务可以与任何任务并行，驱动输入的任务之间互斥。
+ * 所有方法都是线程安全的。
+ */
+class ResourceScheduler {
+public:
+    static constexpr uint32_t EXCLUSIVE_RESOURCES = RESOURCE_INPUT | RESOURCE_FOREGROUND;
+
+    ResourceScheduler() = default;
+
+    ResourceScheduler(const ResourceScheduler&) = delete;
+    ResourceScheduler& operator=(const ResourceScheduler&) = delete;
+
+    /**
+     * @brief 为 owner 申请资源。owner 已有的登记会被替换，不会与自身冲突。
+     * @param error 与其他任务冲突时写入的错误描述。
+     * @return 申请成功返回 true。
+     */
+    bool tryAcquire(const std::string& owner, uint32_t resources, std::string& error);
+
+    void release(const std::string& owner);
+
+    /**
+     * @brief 查找持有冲突资源的任务（不含 owner 自身）。
+     * @return 无冲突时返回空字符串。
+     */
+    std::string findConflict(uint32_t resources, const std::string& owner = {}) const;
+
+    /**
+     * @brief 当前分配情况：{"input": 任务名|null, "foreground": 任务名|null, "capture": [任务名...]}。
+     */
+    json snapshot() const;
+
+    /**
+     * @brief 资源集合的 JSON 表示，如 ["input", "capture"]。
+     */
+    static json toJson(uint32_t resources);
+
+    /**
+     * @brief 资源集合的中文描述，如 "输入、截图"。
+     */
+    static std::string describe(uint32_t resources);
+
+private:
+    std::string findConflictLocked(uint32_t resources, const std::string& owner) const;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, uint32_t> holdings_;  // 任务名 -> 持有的资源
+};
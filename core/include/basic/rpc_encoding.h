@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief JSON-RPC 通道的消息编码。
+ *
+ * Text 为默认编码：每条消息是一行 JSON 文本，以换行分隔。
+ * Cbor / MsgPack 为二进制编码：每条消息前附 4 字节大端长度，随后是对应格式的负载。
+ */
+namespace RpcEncoding {
+
+enum class Mode : uint8_t {
+    Text,
+    Cbor,
+    MsgPack,
+};
+
+// 二进制帧长度前缀的字节数
+constexpr size_t FRAME_HEADER_SIZE = 4;
+
+// 单个二进制帧允许的最大负载，超过即视为流已损坏
+constexpr uint32_t MAX_FRAME_SIZE = 16u * 1024u * 1024u;
+
+inline std::optional<Mode> from_string(std::string_view value) {
+    if (value == "text" || value == "json") {
+        return Mode::Text;
+    }
+    if (value == "cbor") {
+        return Mode::Cbor;
+    }
+    if (value == "msgpack" || value == "messagepack") {
+        return Mode::MsgPack;
+    }
+    return std::nullopt;
+}
+
+inline const char* to_string(Mode mode) {
+    switch (mode) {
+    case Mode::Cbor:
+        return "cbor";
+    case Mode::MsgPack:
+        return "msgpack";
+    case Mode::Text:
+    default:
+        return "text";
+    }
+}
+
+inline bool is_binary(Mode mode) {
+    return mode != Mode::Text;
+}
+
+inline void write_frame_header(char* header, uint32_t size) {
+    header[0] = static_cast<char>((size >> 24) & 0xFF);
+    header[1] = static_cast<char>((size >> 16) & 0xFF);
+    header[2] = static_cast<char>((size >> 8) & 0xFF);
+    header[3] = static_cast<char>(size & 0xFF);
+}
+
+inline uint32_t read_frame_header(const char* header) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(header);
+    return (static_cast<uint32_t>(bytes[0]) << 24) |
+           (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) |
+           static_cast<uint32_t>(bytes[3]);
+}
+
+/**
+ * @brief 将 JSON 对象编码为一条完整的可写出消息（含分隔符或长度前缀）。
+ */
+inline std::string encode(const json& j, Mode mode) {
+    if (mode == Mode::Text) {
+        std::string line = j.dump();
+        line.push_back('\n');
+        return line;
+    }
+
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    if (mode == Mode::Cbor) {
+        json::to_cbor(j, frame);
+    } else {
+        json::to_msgpack(j, frame);
+    }
+    write_frame_header(frame.data(), static_cast<uint32_t>(frame.size() - FRAME_HEADER_SIZE));
+    return frame;
+}
+
+/**
+ * @brief 解码一条消息的负载（不含分隔符或长度前缀）。
+ * @throws json::exception 负载不是合法的对应格式时抛出。
+ */
+inline json decode(std::string_view payload, Mode mode) {
+    switch (mode) {
+    case Mode::Cbor:
+        return json::from_cbor(payload.begin(), payload.end());
+    case Mode::MsgPack:
+        return json::from_msgpack(payload.begin(), payload.end());
+    case Mode::Text:
+    default:
+        return json::parse(payload.begin(), payload.end());
+    }
+}
+
+/**
+ * @brief 解码一条由 encode 生成的完整消息。
+ */
+inline json decode_message(std::string_view message, Mode mode) {
+    if (mode == Mode::Text) {
+        while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) {
+            message.remove_suffix(1);
+        }
+        return decode(message, mode);
+    }
+    return decode(message.substr(FRAME_HEADER_SIZE), mode);
+}
+
+} // namespace RpcEncoding
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "nlohmann/json.hpp"
+#include "basic/latency_histogram.h"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 表驱动的 JSON-RPC 方法注册表。
+ *
+ * 各子系统在服务启动前通过 registerMethod 注册自己的方法，此后注册表只读，
+ * 多个线程可以无锁并发查找与调用。方法以预先计算的 64 位 FNV-1a 哈希为键，
+ * 每个方法自动统计调用次数、错误次数与延迟分布，可通过 app/rpcStats 查询。
+ */
+class RpcRegistry {
+public:
+    // 处理器返回的 json 将作为响应的 result；抛出 RpcException 表示业务错误
+    using Handler = std::function<json(const json& params)>;
+
+    static constexpr uint64_t hashMethod(std::string_view name) {
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief 注册一个方法。必须在开始处理请求之前调用。
+     * @param fast_lane 只读且廉价的方法可标记为快速通道，在读取线程上直接执行，不进入工作队列。
+     * @throws std::logic_error 方法重复注册或哈希冲突时抛出。
+     */
+    void registerMethod(std::string name, Handler handler, bool fast_lane = false);
+
+    bool isFastLane(std::string_view method) const;
+
+    /**
+     * @brief 调用请求对应的方法，并构造完整的 JSON-RPC 响应。
+     */
+    json call(const json& request) const;
+
+    /**
+     * @brief 导出所有方法的调用统计。
+     */
+    json stats() const;
+
+private:
+    struct Entry {
+        std::string name;
+        Handler handler;
+        bool fast_lane = false;
+        mutable std::atomic<uint64_t> calls{0};
+        mutable std::atomic<uint64_t> errors{0};
+        mutable LatencyHistogram latency;
+    };
+
+    const Entry* find(std::string_view method) const;
+
+    std::unordered_map<uint64_t, std::unique_ptr<Entry>> methods_;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "mpsc_queue.h"
+#include "rpc_encoding.h"
+
+/**
+ * @brief 进程唯一的 stdout 写线程。
+ *
+ * 任意线程调用 enqueue 只会把已序列化好的消息挂入无锁队列，
+ * 真正的输出由专用线程完成：它一次取空队列，把多条消息拼接为一次大块写入，
+ * 每批只 flush 一次。这样调用方不会因为管道写入而阻塞，不同线程的消息也不会交错。
+ *
+ * 每条消息都标记了它被序列化时使用的编码。通道编码切换以一条标记消息的形式入队，
+ * 写线程据此保证切换点之前的输出都使用旧编码、之后的都使用新编码；
+ * 少数恰好跨越切换点的消息会在写线程中重新编码。
+ *
+ * 除了预先序列化好的字节，调用方也可以入队自定义的 OutboundMessage，
+ * 把序列化推迟到写线程上按通道当前编码完成（例如池化的日志记录）。
+ */
+class RpcWriter {
+public:
+    /**
+     * @brief 写线程上的一条待输出消息。
+     */
+    struct OutboundMessage : MpscNode {
+        virtual ~OutboundMessage() = default;
+
+        /**
+         * @brief 按通道当前编码把消息追加到批次缓冲，只在写线程上调用。
+         */
+        virtual void appendTo(std::string& batch, RpcEncoding::Mode channel_encoding) = 0;
+
+        /**
+         * @brief 消息写出后由写线程调用。默认释放堆内存，池化的消息在此归还到池中。
+         */
+        virtual void release() { delete this; }
+
+        /**
+         * @brief 若消息是编码切换点，返回 true 并给出新编码。
+         */
+        virtual bool switchesEncoding(RpcEncoding::Mode& /*target*/) const { return false; }
+    };
+
+    static RpcWriter& instance();
+
+    RpcWriter(const RpcWriter&) = delete;
+    RpcWriter& operator=(const RpcWriter&) = delete;
+
+    /**
+     * @brief 入队一条完整的消息（包含分隔符或长度前缀），不阻塞。
+     * @param encoding 生成 bytes 时使用的编码。
+     */
+    void enqueue(std::string bytes, RpcEncoding::Mode encoding);
+
+    /**
+     * @brief 入队一个编码切换点，此后写出的消息都使用新编码。
+     */
+    void switchEncoding(RpcEncoding::Mode encoding);
+
+    /**
+     * @brief 入队一条自定义消息，不阻塞。写出后写线程会调用 message->release()。
+     */
+    void enqueue(OutboundMessage* message);
+
+    /**
+     * @brief 阻塞直到调用前入队的所有消息都已写出。
+     */
+    void flush();
+
+private:
+    struct EncodedMessage;
+    struct EncodingSwitch;
+
+    explicit RpcWriter(std::ostream& out);
+    ~RpcWriter();
+
+    void writerLoop();
+    size_t drainInto(std::string& batch);
+    void writeBatch(std::string& batch);
+    void applyChannelEncoding(RpcEncoding::Mode encoding);
+
+    std::ostream& out_;
+    MpscQueue queue_;
+    RpcEncoding::Mode channel_encoding_ = RpcEncoding::Mode::Text; // 仅由写线程访问
+
+    std::atomic<bool> writer_sleeping_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> enqueued_count_{0};
+    std::atomic<uint64_t> written_count_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable flushed_cv_;
+
+    std::thread writer_thread_;
+};
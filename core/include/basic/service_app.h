@@ -1,17 +1,68 @@
 #pragma once
 
 #include "task_manager.h"
+#include "bounded_queue.h"
+#include "rpc_registry.h"
+#include "metrics.h"
+#include "automator/asset_prewarmer.h"
 #include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
 class ServiceApp {
 private:
+    // 待处理请求队列的容量，队列满时新请求会被直接拒绝
+    static constexpr size_t REQUEST_QUEUE_CAPACITY = 64;
+    // 处理慢请求（如 task/start）的工作线程数量
+    static constexpr size_t WORKER_COUNT = 2;
+
     TaskManager task_manager_;
+    RpcRegistry rpc_registry_;
     std::atomic<bool> shutdown_requested_ {false}; // 用于线程安全地请求关闭
 
-    // 处理从stdin接收到的单个命令
-    void processCommand(const json& j_request);
+    // 一个批量请求的汇总状态：所有子请求完成后，一次性写出整个响应数组
+    struct BatchContext {
+        std::vector<json> responses;
+        std::atomic<size_t> remaining{0};
+    };
+
+    // 等待处理的单个请求；属于批量请求时记录其所在批次与下标
+    struct PendingRequest {
+        json request;
+        std::shared_ptr<BatchContext> batch;
+        size_t index = 0;
+    };
+
+    BoundedQueue<PendingRequest> request_queue_ {REQUEST_QUEUE_CAPACITY};
+    std::vector<std::thread> workers_;
+
+    MetricsStreamer metrics_streamer_;
+    AssetPrewarmer asset_prewarmer_;
+
+    // 注册由 ServiceApp 自身提供的 app/* 方法
+    void registerAppMethods();
+
+    // 分派一条消息：单个请求或批量请求数组
+    void dispatchMessage(json message);
+
+    // 将一个有效请求分派到快速通道或工作队列
+    void dispatchRequest(PendingRequest pending);
+
+    // 执行请求并提交其响应
+    void executeRequest(const PendingRequest& pending);
+
+    // 提交一个请求的响应：单个请求立即发送，批量请求在最后一个子请求完成时整体发送
+    static void completeRequest(const PendingRequest& pending, json response);
+
+    // 工作线程主循环
+    void workerLoop();
+
+    // app/setEncoding 需要先发出响应再切换编码，因此不经过方法注册表
+    void handleSetEncoding(const json& j_request);
 
 public:
     ServiceApp();
+    ~ServiceApp();
     void run();
 };
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "basic/frame_loop.h"
+#include "basic/metrics.h"
+#include "basic/stop_token.h"
+#include "basic/triple_buffer.h"
+
+/**
+ * @brief 流水线阶段之间的唤醒信号。
+ *
+ * 消费端没有新数据时在此阻塞；notify 在消费端忙碌（没有等待者）时只有一次原子自增，
+ * 不会进入互斥锁，生产端的发布路径因此保持无锁。
+ */
+class StageSignal {
+public:
+    StageSignal() = default;
+
+    StageSignal(const StageSignal&) = delete;
+    StageSignal& operator=(const StageSignal&) = delete;
+
+    void notify();
+
+    /**
+     * @brief 关闭信号，唤醒所有等待者，之后的 wait 立即返回 false。
+     */
+    void close();
+
+    /**
+     * @brief 等待 seen 之后的下一次 notify，并把 seen 更新为最新的序号。
+     * @return 信号已关闭时返回 false。
+     */
+    bool wait(uint64_t& seen);
+
+private:
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<int> waiters_{0};
+    std::atomic<bool> closed_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+/**
+ * @brief 截图 → 识别 → 执行 三段流水线。
+ *
+ * 阶段之间通过 TripleBuffer 传递数据，下游总是处理最新的一帧，来不及处理的帧直接丢弃。
+ * 流水线模式下截图在调用线程上按 FrameLoop 的节奏运行，识别与执行各占一个线程，
+ * 截图第 N+1 帧时不再需要等待第 N 帧识别完成；串行模式在同一线程上依次调用三个阶段，
+ * 阶段函数在两种模式下完全相同，任务只需通过构造参数选择模式。
+ *
+ * 每个阶段只在自己的线程上运行，阶段内部的状态不需要加锁；
+ * 需要跨帧累积、不能因丢帧而遗漏的事件（例如按键）应编码为单调递增的计数传给下游。
+ *
+ * 指标（前缀由构造参数给出，直方图单位为微秒）：
+ *   <prefix>.capture / .analyze / .act  各阶段单次耗时
+ *   <prefix>.captures_dropped           识别阶段来不及处理而丢弃的截图数
+ *   <prefix>.results_dropped            执行阶段来不及处理而丢弃的识别结果数
+ * 帧间隔与抖动由内部的 FrameLoop 以同一前缀记录。
+ */
+template <typename Captured, typename Analyzed>
+class StagePipeline {
+public:
+    /**
+     * @brief 截图阶段，就地填充 Captured；返回 next 时发布该帧，返回 backoff/stop 时不发布。
+     */
+    using CaptureStage = std::function<FrameLoop::Action(const FrameLoop::Frame&, Captured&)>;
+    /**
+     * @brief 识别阶段，就地填充 Analyzed；返回 false 时不发布结果。
+     */
+    using AnalyzeStage = std::function<bool(const Captured&, Analyzed&)>;
+    using ActStage = std::function<void(const Analyzed&)>;
+
+    struct Stages {
+        CaptureStage capture;
+        AnalyzeStage analyze;
+        ActStage act;
+    };
+
+    StagePipeline(StopToken& stop_token, const std::string& metrics_prefix, FrameLoop::Options loop_options, bool pipelined)
+        : stop_token_(stop_token),
+          loop_(stop_token, metrics_prefix, loop_options),
+          pipelined_(pipelined),
+          capture_latency_(Metrics::instance().histogram(metrics_prefix + ".capture")),
+          analyze_latency_(Metrics::instance().histogram(metrics_prefix + ".analyze")),
+          act_latency_(Metrics::instance().histogram(metrics_prefix + ".act")),
+          captures_dropped_(Metrics::instance().counter(metrics_prefix + ".captures_dropped")),
+          results_dropped_(Metrics::instance().counter(metrics_prefix + ".results_dropped")) {}
+
+    StagePipeline(const StagePipeline&) = delete;
+    StagePipeline& operator=(const StagePipeline&) = delete;
+
+    bool pipelined() const { return pipelined_; }
+
+    /**
+     * @brief 运行流水线，直到截图阶段返回 stop 或收到停止请求。
+     *
+     * 任一阶段抛出的异常会停止整条流水线，并在所有线程退出后从 run 重新抛出。
+     */
+    void run(const Stages& stages) {
+        if (pipelined_) {
+            runPipelined(stages);
+        } else {
+            runSerial(stages);
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool captureFrame(const Stages& stages, const FrameLoop::Frame& frame, FrameLoop::Action& action) {
+        const auto start = Clock::now();
+        action = stages.capture(frame, captured_.writeBuffer());
+        if (action.kind() != FrameLoop::Action::Kind::Next) {
+            return false;
+        }
+        capture_latency_.record(Clock::now() - start);
+        if (captured_.publish()) {
+            captures_dropped_.add();
+        }
+        return true;
+    }
+
+    bool analyzeLatest(const Stages& stages) {
+        if (!captured_.update()) {
+            return false;
+        }
+        const auto start = Clock::now();
+        const bool produced = stages.analyze(captured_.readBuffer(), analyzed_.writeBuffer());
+        analyze_latency_.record(Clock::now() - start);
+        if (produced && analyzed_.publish()) {
+            results_dropped_.add();
+        }
+        return produced;
+    }
+
+    bool actLatest(const Stages& stages) {
+        if (!analyzed_.update()) {
+            return false;
+        }
+        ScopedLatency timer(act_latency_);
+        stages.act(analyzed_.readBuffer());
+        return true;
+    }
+
+    void runSerial(const Stages& stages) {
+        loop_.run([&](const FrameLoop::Frame& frame) {
+            FrameLoop::Action action = FrameLoop::Action::next();
+            if (captureFrame(stages, frame, action) && analyzeLatest(stages)) {
+                actLatest(stages);
+            }
+            return action;
+        });
+    }
+
+    void runPipelined(const Stages& stages) {
+        StageSignal captured_signal;
+        StageSignal analyzed_signal;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        std::atomic<bool> failed{false};
+
+        auto fail = [&](std::exception_ptr e) {
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = e;
+                }
+            }
+            failed.store(true, std::memory_order_release);
+            captured_signal.close();
+            analyzed_signal.close();
+        };
+
+        std::thread analyzer([&] {
+            StopToken::Binding binding(stop_token_);
+            try {
+                uint64_t seen = 0;
+                for (;;) {
+                    if (analyzeLatest(stages)) {
+                        analyzed_signal.notify();
+                    } else if (!captured_signal.wait(seen)) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        });
+
+        std::thread actor([&] {
+            StopToken::Binding binding(stop_token_);
+            try {
+                uint64_t seen = 0;
+                for (;;) {
+                    if (!actLatest(stages) && !analyzed_signal.wait(seen)) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        });
+
+        try {
+            loop_.run([&](const FrameLoop::Frame& frame) {
+                if (failed.load(std::memory_order_acquire)) {
+                    return FrameLoop::Action::stop();
+                }
+                FrameLoop::Action action = FrameLoop::Action::next();
+                if (captureFrame(stages, frame, action)) {
+                    captured_signal.notify();
+                }
+                return action;
+            });
+        } catch (...) {
+            fail(std::current_exception());
+        }
+
+        // 识别线程退出后不会再有新的结果发布，此时再关闭执行阶段的信号
+        captured_signal.close();
+        analyzer.join();
+        analyzed_signal.close();
+        actor.join();
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    StopToken& stop_token_;
+    FrameLoop loop_;
+    const bool pipelined_;
+
+    TripleBuffer<Captured> captured_;
+    TripleBuffer<Analyzed> analyzed_;
+
+    LatencyHistogram& capture_latency_;
+    LatencyHistogram& analyze_latency_;
+    LatencyHistogram& act_latency_;
+    Metrics::Counter& captures_dropped_;
+    Metrics::Counter& results_dropped_;
+};
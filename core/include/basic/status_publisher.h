@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 任务状态的变更推送器。
+ *
+ * 任务只在状态字段确实变化时调用 publish 提交增量，推送线程以不超过设定频率的节奏
+ * 合并同一任务的多次增量，并发送 task/status 通知：
+ *   {"name": 任务名, "seq": 序号, "changes": {只包含变化的字段}}
+ * seq 在整个进程内单调递增，客户端发现跳号时可以调用 app/getStatus 重新同步全量状态。
+ */
+class StatusPublisher {
+public:
+    static constexpr double DEFAULT_MAX_RATE_HZ = 10.0;
+    static constexpr double MIN_RATE_HZ = 0.5;
+    static constexpr double MAX_RATE_HZ = 120.0;
+
+    StatusPublisher();
+    ~StatusPublisher();
+
+    StatusPublisher(const StatusPublisher&) = delete;
+    StatusPublisher& operator=(const StatusPublisher&) = delete;
+
+    /**
+     * @brief 提交一个任务的状态增量，不阻塞。同一字段在下次推送前的多次修改只保留最后一次。
+     */
+    void publish(const std::string& task_name, const json& changes);
+
+    /**
+     * @brief 设置最大推送频率，超出 [MIN_RATE_HZ, MAX_RATE_HZ] 的值会被截断。
+     * @return 实际生效的频率。
+     */
+    double setMaxRate(double rate_hz);
+    double maxRate() const;
+
+private:
+    void publisherLoop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::string, json> pending_;  // 任务名 -> 合并后的增量
+    std::chrono::steady_clock::duration min_interval_;
+    std::chrono::steady_clock::time_point last_sent_{};
+    uint64_t sequence_ = 0;
+    bool stopping_ = false;
+
+    std::thread thread_;
+};
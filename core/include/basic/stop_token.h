@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief 可被停止请求立即唤醒的等待原语。
+ *
+ * 任务中所有的睡眠与轮询等待都应经过 sleepFor/sleepUntil，
+ * requestStop 会唤醒正在等待的线程，停止请求的响应时间不再取决于睡眠时长。
+ *
+ * 通过 Binding 把令牌绑定到当前线程后，输入、截图等不持有任务对象的模块
+ * 也可以用 sleepOnCurrentThread 进行可中断的等待；未绑定的线程退化为普通睡眠。
+ */
+class StopToken {
+public:
+    StopToken() = default;
+
+    StopToken(const StopToken&) = delete;
+    StopToken& operator=(const StopToken&) = delete;
+
+    void requestStop();
+
+    /**
+     * @brief 清除停止请求，只能在没有线程等待时调用。
+     */
+    void reset();
+
+    bool stopRequested() const { return stop_requested_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 最近一次 requestStop 的时间，仅在 stopRequested() 为 true 时有意义。
+     */
+    std::chrono::steady_clock::time_point requestedAt() const;
+
+    /**
+     * @brief 等待到指定时间点。
+     * @return 等满返回 true；期间收到停止请求（或调用前已请求停止）返回 false。
+     */
+    bool sleepUntil(std::chrono::steady_clock::time_point deadline);
+
+    template <typename Rep, typename Period>
+    bool sleepFor(const std::chrono::duration<Rep, Period>& duration) {
+        return sleepUntil(std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration));
+    }
+
+    /**
+     * @brief 在作用域内把令牌绑定到当前线程。
+     */
+    class Binding {
+    public:
+        explicit Binding(StopToken& token) : previous_(current_) { current_ = &token; }
+        ~Binding() { current_ = previous_; }
+
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+
+    private:
+        StopToken* previous_;
+    };
+
+    /**
+     * @brief 使用当前线程绑定的令牌等待，返回值同 sleepFor。
+     */
+    template <typename Rep, typename Period>
+    static bool sleepOnCurrentThread(const std::chrono::duration<Rep, Period>& duration) {
+        if (current_) {
+            return current_->sleepFor(duration);
+        }
+        std::this_thread::sleep_for(duration);
+        return true;
+    }
+
+    /**
+     * @brief 当前线程绑定的令牌是否已请求停止，未绑定时返回 false。
+     */
+    static bool currentStopRequested() { return current_ && current_->stopRequested(); }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> stop_requested_{false};
+    std::chrono::steady_clock::time_point requested_at_{};
+
+    static inline thread_local StopToken* current_ = nullptr;
+};
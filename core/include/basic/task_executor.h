@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+
+/**
+ * @brief 常驻的任务执行线程池，由 TaskManager 持有。
+ *
+ * 任务体作为作业提交给固定的工作线程执行，启动任务不再需要创建线程。
+ * 同一时刻运行的任务数不会超过线程数，多出的作业排队等待。
+ */
+class TaskExecutor {
+public:
+    static constexpr size_t JOB_QUEUE_CAPACITY = 16;
+
+    explicit TaskExecutor(size_t worker_count);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    /**
+     * @brief 提交一个作业，不阻塞。
+     * @return 作业队列已满或执行器已关闭时返回 false。
+     */
+    bool submit(std::function<void()> job);
+
+    size_t workerCount() const { return workers_.size(); }
+
+private:
+    void workerLoop();
+
+    BoundedQueue<std::function<void()>> jobs_;
+    std::vector<std::thread> workers_;
+};
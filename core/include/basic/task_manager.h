@@ -1,24 +1,148 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <functional>
+#include <thread>
+#include <vector>
 #include "nlohmann/json.hpp"
 #include "basic/base_task.h"
+#include "basic/resource_scheduler.h"
+#include "basic/rpc_registry.h"
+#include "basic/status_publisher.h"
+#include "basic/task_executor.h"
 
 using json = nlohmann::json;
 
+/**
+ * @brief 任务描述，getTaskList 与任务创建共用同一张表。
+ *
+ * 队列约束：
+ *   singleton  —— 同一队列中最多出现一次；
+ *   must_last  —— 只能位于队列末尾；
+ *   is_looping —— 不会自行结束，因此同样只能位于队列末尾。
+ *
+ * resources 为 TaskResource 的组合，声明任务运行期间需要的资源，决定哪些任务可以同时运行。
+ */
+struct TaskDescriptor {
+    const char* name;
+    const char* label;
+    bool singleton;
+    bool must_last;
+    bool is_looping;
+    uint32_t resources;
+    std::shared_ptr<BaseTask> (*create)(const std::string& name);
+};
+
+/**
+ * @brief 任务管理器。
+ *
+ * 所有公开方法都是线程安全的：启动请求之间互斥，
+ * 状态查询只在极短的时间内持有锁，不会被正在进行的启动请求阻塞。
+ *
+ * 任务队列由内部的执行线程推进：任务结束时通过完成回调唤醒执行线程，
+ * 下一个任务立即在后端启动，不需要等待客户端轮询或往返请求。
+ *
+ * 任务体运行在常驻的 TaskExecutor 线程上，每种任务的对象在首次启动时创建并一直复用，
+ * 启动任务的关键路径上不再有线程创建与任务初始化。
+ *
+ * 多个任务可以同时运行：启动前按 TaskDescriptor::resources 向 ResourceScheduler 申请资源，
+ * 只有独占资源冲突时才拒绝启动，任务结束时自动释放。同一种任务同一时刻只运行一个实例。
+ */
 class TaskManager {
 private:
-    std::unique_ptr<BaseTask> current_task_;
+    struct QueuedTask {
+        std::string name;
+        json params;
+    };
+
+    struct RunningTask {
+        std::shared_ptr<BaseTask> task;
+        uint64_t generation;  // 区分同一任务的先后两次运行，旧运行的完成回调不会影响新运行
+    };
+
+    std::shared_ptr<BaseTask> current_task_;  // 最近启动的任务，用于兼容只显示单个任务的客户端
     std::shared_ptr<Logger> logger_;
-    std::string last_error_;
+    std::shared_ptr<StatusPublisher> status_publisher_;
+    std::shared_ptr<TaskExecutor> executor_;
+    std::map<std::string, std::shared_ptr<BaseTask>> task_instances_;  // 受 start_mutex_ 保护
+    ResourceScheduler resources_;
+
+    mutable std::mutex task_mutex_;  // 保护 current_task_、running_tasks_ 与 launch_generation_
+    std::map<std::string, RunningTask> running_tasks_;
+    uint64_t launch_generation_ = 0;
+    std::mutex start_mutex_;         // 串行化启动请求
+
+    mutable std::mutex queue_mutex_;  // 保护以下队列状态
+    std::condition_variable queue_cv_;
+    std::deque<QueuedTask> pending_queue_;
+    std::vector<std::string> queue_names_;  // 当前队列的完整顺序，用于状态查询
+    size_t queue_position_ = 0;             // 已出队的任务数
+    uint64_t queue_generation_ = 0;         // 每次开始或清空队列时递增
+    bool queue_active_ = false;
+    bool queue_task_running_ = false;       // 队列启动的任务尚未结束
+    bool queue_stopping_ = false;
+    std::thread queue_thread_;
+
+    std::shared_ptr<BaseTask> currentTask() const;
+    std::vector<std::shared_ptr<BaseTask>> runningTasks() const;
+    // 调用方必须持有 start_mutex_
+    bool launchTaskLocked(const std::string& task_name, const json& params, bool from_queue, std::string& error);
+    void onTaskFinished(const std::string& task_name, uint64_t generation, bool from_queue);
+    void queueLoop();
+    static void notifyQueue(const char* state, const std::string& task_name, json queue_status);
+    json queueStatusLocked() const;
+    // 调用方必须持有 start_mutex_
+    bool clearQueueLocked();
 
 public:
-    explicit TaskManager(std::function<void(const json&)> sender);
+    // 每个运行中的任务占用一个执行线程
+    static constexpr size_t MAX_CONCURRENT_TASKS = 4;
+    static constexpr size_t EXECUTOR_THREADS = MAX_CONCURRENT_TASKS;
 
-    bool startTask(const std::string& task_name, const json& params);
-    bool stopCurrentTask();
-    std::string getLastError() const;
+    TaskManager();
+    ~TaskManager();
+
+    TaskManager(const TaskManager&) = delete;
+    TaskManager& operator=(const TaskManager&) = delete;
+
+    static const std::vector<TaskDescriptor>& descriptors();
+    static const TaskDescriptor* findDescriptor(const std::string& task_name);
+
+    /**
+     * @brief 启动指定任务，可以与不冲突的任务同时运行。
+     *
+     * 任务队列执行期间只能启动不占用独占资源的任务。
+     * @param error 启动失败时写入的错误描述。
+     * @return 启动成功返回 true。
+     */
+    bool startTask(const std::string& task_name, const json& params, std::string& error);
+
+    /**
+     * @brief 按顺序执行一组任务，每项为 {"task_name": ..., 其余为该任务的启动参数}。
+     *
+     * 队列按 TaskDescriptor 的约束校验，不做重排；某个任务启动失败或执行失败时继续执行下一个，
+     * 不带任务名调用 stopTasks 会清空剩余队列。进度以 task/queue 通知推送。
+     * @param error 校验失败时写入的错误描述。
+     * @return 队列已开始执行返回 true。
+     */
+    bool startQueue(const json& items, std::string& error);
+
+    /**
+     * @brief 停止任务。
+     * @param task_name 为空时停止所有任务并清空剩余队列；否则只停止该任务，队列继续执行下一个。
+     * @return 确实停止了任务或清空了队列时返回 true。
+     */
+    bool stopTasks(const std::string& task_name = {});
     json getStatus() const;
     json getTaskList() const;
+
+    /**
+     * @brief 向注册表注册任务相关的 RPC 方法（task/start、task/startQueue、task/stop、app/getStatus、app/getTasks）。
+     */
+    void registerRpcMethods(RpcRegistry& registry);
 };
@@ -1,17 +1,63 @@
 #pragma once
 
 #include "base_task.h"
+#include "stop_token.h"
 #include <vector>
-#include <map>
+#include <chrono>
 #include <functional>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+
+class LatencyHistogram;
+
+/**
+ * @brief 工作流步骤的返回值，决定下一步的去向。
+ */
+class StepResult {
+public:
+    enum class Kind {
+        Next,   // 按注册顺序进入下一步，最后一步之后结束
+        Goto,   // 跳转到指定步骤，可以跳回之前的步骤形成循环
+        Done,   // 工作流成功结束
+        Retry,  // 暂时性失败，按步骤的重试策略重新执行
+        Fail    // 不可恢复的失败，立即结束工作流
+    };
+
+    static StepResult next() { return StepResult(Kind::Next); }
+    static StepResult jump(int step_id) { return StepResult(Kind::Goto, step_id); }
+    static StepResult done() { return StepResult(Kind::Done); }
+    static StepResult retry() { return StepResult(Kind::Retry); }
+    static StepResult fail() { return StepResult(Kind::Fail); }
+
+    Kind kind() const { return kind_; }
+    int target() const { return target_; }
+
+private:
+    explicit StepResult(Kind kind, int target = -1) : kind_(kind), target_(target) {}
+
+    Kind kind_;
+    int target_;
+};
+
+/**
+ * @brief 单个步骤的执行策略。
+ *
+ * timeout 是该步骤所有尝试共用的时间预算。步骤不会被强行打断，
+ * 长时间运行的步骤应在循环中检查 stepTimedOut()；超出预算后不再重试。
+ */
+struct StepPolicy {
+    int max_attempts = 1;                       // 包括第一次执行；0 表示不限次数，只受 timeout 约束
+    std::chrono::milliseconds retry_delay{0};
+    std::chrono::milliseconds timeout{0};       // 0 表示不限时
+};
 
 class ThreadedTask : public BaseTask {
 public:
     using StepId = int;
     using StepAction = std::function<bool()>;
+    using StepFunction = std::function<StepResult()>;
 
     explicit ThreadedTask(std::string name);
     ~ThreadedTask() override;
@@ -22,26 +68,92 @@ public:
     json getStatus() const final;
     void start(const json& params, std::shared_ptr<const Logger> logger) override;
     void stop() final;
+    void setStatusPublisher(std::shared_ptr<StatusPublisher> publisher) final;
+    void setFinishedCallback(std::function<void()> callback) final;
+    /**
+     * @brief 设置后任务体作为作业在执行器上运行，未设置时每次启动创建独立线程。
+     * 任务对象可以反复 start，子类成员（缓冲区、缓存等）在多次运行之间保留。
+     */
+    void setExecutor(std::shared_ptr<TaskExecutor> executor) final;
 
 protected:
+    /**
+     * @brief 注册一个线性步骤：返回 true 进入下一步，返回 false 使工作流失败。
+     */
     void registerStep(StepId step_id, StepAction action);
+
+    /**
+     * @brief 注册一个状态机步骤，由返回值决定下一步。
+     *
+     * StepId 直接作为下标，应使用从 0 开始的连续枚举值。
+     * 步骤抛出的 WindowException 与 ScreenshotFailedException 视为暂时性失败，与 Retry 一样按策略重试。
+     */
+    void registerStep(StepId step_id, StepFunction action, StepPolicy policy = {});
+
+    /**
+     * @brief 当前步骤是否已用完 StepPolicy::timeout 的时间预算，只能在步骤内调用。
+     */
+    bool stepTimedOut() const;
+
+    /**
+     * @brief 可被 stop() 立即打断的睡眠，任务中的等待都应使用它代替 sleep_for。
+     * @return 睡满返回 true，被停止请求打断返回 false。
+     */
+    template <typename Rep, typename Period>
+    bool sleepFor(const std::chrono::duration<Rep, Period>& duration) {
+        return stop_token_.sleepFor(duration);
+    }
+
+    bool stopRequested() const { return stop_token_.stopRequested(); }
+    StopToken& stopToken() { return stop_token_; }
+
+    /**
+     * @brief 请求停止并等待任务体退出。持有运行期资源的子类应在析构函数开头调用，
+     * 保证成员析构时任务体已不再访问它们。
+     */
+    void stopAndWait();
+
+    /**
+     * @brief 更新状态，只有确实变化的字段才会被推送。
+     */
     void updateStatus(const std::string& status_text, int progress = -1);
 
     // 供子类使用的受保护成员
     std::string task_name_;
     json params_;
     std::shared_ptr<const Logger> logger_;
-    std::atomic<bool> stop_requested_{false};
+    StopToken stop_token_;  // 任务线程运行期间绑定到该线程，见 StopToken::Binding
 
 private:
-    std::thread task_thread_;
+    std::thread task_thread_;               // 未设置执行器时使用
+    std::shared_ptr<TaskExecutor> executor_;
     std::atomic<bool> is_running_{false};
+
+    std::mutex job_mutex_;
+    std::condition_variable job_cv_;
+    bool job_active_ = false;  // 任务体（含收尾）是否仍在执行，受 job_mutex_ 保护
     
-    std::vector<StepId> workflow_sequence_;
-    std::map<StepId, StepAction> step_actions_;
+    struct Step {
+        StepFunction action;  // 为空表示该下标未注册
+        StepPolicy policy;
+        size_t order = 0;     // 在注册顺序中的位置，决定 Next 的去向与进度
+        LatencyHistogram* latency = nullptr;
+    };
+
+    std::vector<Step> steps_;               // 以 StepId 为下标
+    std::vector<StepId> workflow_sequence_; // 注册顺序
+    std::chrono::steady_clock::time_point step_deadline_ = std::chrono::steady_clock::time_point::max();
 
     mutable std::mutex status_mutex_;
     json task_status_json_;
+    std::shared_ptr<StatusPublisher> status_publisher_;  // 受 status_mutex_ 保护
+    std::function<void()> finished_callback_;
 
     void run();
+    void finish();
+    void waitForJob();
+    /**
+     * @brief 按策略执行一个步骤（含重试），返回最终结果；失败原因已写入日志。
+     */
+    StepResult executeStep(StepId step_id, const Step& step);
 };
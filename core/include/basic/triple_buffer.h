@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 无锁的单生产者/单消费者三缓冲。
+ *
+ * 三个槽位分别归写端、读端和中转位所有：写端在 writeBuffer 上就地填充，
+ * publish 把它与中转位原子交换；读端 update 在有新数据时把中转位换到读端。
+ * 双方都不会等待对方，读端总是拿到最新发布的数据，未被读取就被覆盖的旧数据直接丢弃。
+ *
+ * 槽位对象在整个生命周期内复用，适合存放 cv::Mat 等可就地重用内存的缓冲区。
+ * writeBuffer/publish 只能由唯一的写线程调用，update/readBuffer 只能由唯一的读线程调用。
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    T& writeBuffer() { return buffers_[back_]; }
+
+    /**
+     * @brief 发布 writeBuffer 中的数据，之后 writeBuffer 指向另一个槽位。
+     * @return 上一次发布的数据尚未被读端取走、因此被丢弃时返回 true。
+     */
+    bool publish() {
+        const uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+        return (previous & FRESH) != 0;
+    }
+
+    /**
+     * @brief 取走最新发布的数据。
+     * @return 有新数据时返回 true，readBuffer 随之更新；否则 readBuffer 保持不变。
+     */
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        const uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers_[front_]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> buffers_;
+    // 写端、中转位、读端分占不同缓存行，避免两个线程互相使对方的缓存失效
+    alignas(64) uint8_t back_ = 0;
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t front_ = 2;
+};
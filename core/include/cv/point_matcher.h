@@ -10,7 +10,13 @@ public:
 
     std::vector<cv::Point2f> get_points(const cv::Mat &scene_image, const cv::Mat &object_image);
 
+    // 提前创建进程共享的 SIFT 检测器与 FLANN 匹配器，避免首次匹配时的初始化开销
+    static void prewarm();
+
 private:
+    static cv::Ptr<cv::Feature2D> shared_detector();
+    static cv::Ptr<cv::DescriptorMatcher> shared_matcher();
+
     // 重投影误差阈值。值越小匹配越严格，值越大容忍度越高
     // 建议范围：3.0-8.0，默认5.0。图像失真大时可适当增大
     double ransac_reproj_thresh;
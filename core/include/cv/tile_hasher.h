@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 按固定大小分块计算画面哈希，找出相邻两帧之间变化的区域。
+ *
+ * 画面静止时（菜单、加载界面、等待上钩）识别结果不会改变，调用方可以据此跳过识别、
+ * 复用上一次的结果。每个分块记录最近一次变化的帧序号，因此不需要每帧都检查同一区域：
+ * 保存识别时的帧序号，之后用 changedSince 判断区域在此期间是否变化过即可。
+ *
+ * 哈希按行顺序读取像素，每个分块用 8 个相互独立的 32 位累加器做“异或后乘奇数”，
+ * 内层循环没有跨通道的依赖，编译器可以直接向量化；1080p 画面约 1ms，远低于一次模板匹配。
+ * 对象不是线程安全的，应由处理该画面的线程独占。
+ */
+class TileHasher {
+public:
+    static constexpr int DEFAULT_TILE_SIZE = 32;
+
+    explicit TileHasher(int tile_size = DEFAULT_TILE_SIZE);
+
+    /**
+     * @brief 计算新一帧的分块哈希并与上一帧比较。画面尺寸或类型变化时所有分块都视为变化。
+     * @return 本帧的序号，从 1 开始。
+     */
+    uint64_t update(const cv::Mat& frame);
+
+    /**
+     * @brief 最近一次 update 的帧序号，尚未处理任何帧时为 0。
+     */
+    uint64_t frame() const { return frame_; }
+
+    int tileSize() const { return tile_size_; }
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+
+    /**
+     * @brief 最近一帧中相对上一帧变化的分块数。
+     */
+    size_t changedCount() const { return changed_count_; }
+
+    bool changed(int tile_x, int tile_y) const;
+
+    /**
+     * @brief region（像素坐标）覆盖的分块在 frame 之后是否变化过。
+     * frame 为 0、画面尺寸在此之后变化过或区域超出画面时视为变化。
+     */
+    bool changedSince(const cv::Rect& region, uint64_t frame) const;
+
+    /**
+     * @brief frame 之后变化过的所有分块的外接矩形（像素坐标，已裁剪到画面内），没有变化时为空矩形。
+     */
+    cv::Rect changedBoundsSince(uint64_t frame) const;
+
+    /**
+     * @brief 最近一帧变化的分块（像素坐标），按行排列，同一行中相邻的分块合并为一个矩形。
+     */
+    std::vector<cv::Rect> changedRegions() const;
+
+private:
+    cv::Rect tileRect(int tile_x, int tile_y) const;
+
+    const int tile_size_;
+    cv::Size size_;
+    int type_ = -1;
+    int cols_ = 0;
+    int rows_ = 0;
+    uint64_t frame_ = 0;
+    size_t changed_count_ = 0;
+
+    std::vector<uint64_t> hashes_;
+    std::vector<uint64_t> changed_at_;  // 各分块最近一次变化的帧序号
+    std::vector<uint32_t> lanes_;       // 一行分块的累加器，跨帧复用
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "io/frame_pool.h"
+#include "io/frame_source.h"
+
+/**
+ * @brief 在多次截图之间复用缓冲区的截图会话。
+ *
+ * 会话从帧源取帧，写入 FramePool 借出的缓冲区并以 FrameHandle 交给调用方。
+ * 能就地写入的帧源（实时截图、BGRA 转储）直接写进池中的缓冲区；
+ * 自己分配新缓冲区的帧源（PNG、视频解码）由会话接管其缓冲区；
+ * 只提供临时视图的帧源（BGR 转储的映射内存）拷贝进池中的缓冲区。
+ * 因此稳定运行时每帧不再分配内存，只在画面尺寸变化时重新分配。
+ *
+ * 与帧源一样，同一个会话只能由一个线程调用 next；借出的句柄可以交给其他线程。
+ */
+class CaptureSession {
+public:
+    struct Stats {
+        uint64_t frames = 0;         // 成功取到的帧数
+        uint64_t reallocations = 0;  // 池中缓冲区被替换的次数（尺寸变化或接管帧源的缓冲区）
+        uint64_t copies = 0;         // 帧源只提供临时视图、需要拷贝的帧数
+        FramePool::Stats pool;
+    };
+
+    explicit CaptureSession(std::shared_ptr<IFrameSource> source, size_t pool_capacity = FramePool::DEFAULT_CAPACITY);
+
+    CaptureSession(const CaptureSession&) = delete;
+    CaptureSession& operator=(const CaptureSession&) = delete;
+
+    /**
+     * @brief 取下一帧。句柄在调用方释放前一直有效，不受之后的 next 影响。
+     * @return 帧源已结束时返回空句柄。
+     * @throw ScreenshotFailedException 实时截图失败。
+     */
+    FrameHandle next();
+
+    IFrameSource& source() { return *source_; }
+
+    Stats stats() const;
+
+private:
+    std::shared_ptr<IFrameSource> source_;
+    FramePool pool_;
+    SourceFrame scratch_;  // 传给帧源的帧，image 在 grab 期间与池中缓冲区共享内存
+    Stats stats_;
+};
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+#include "nlohmann/json.hpp"
+#include "basic/bounded_queue.h"
+#include "io/frame_pool.h"
+#include "io/frame_source.h"
+#include "io/mapped_file.h"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 飞行记录的文件格式（小端）。
+ *
+ *   [FileHeader 32 字节][分块 0][分块 1]...
+ *   分块 = [ChunkHeader 32 字节][记录 0][记录 1]...，ChunkHeader.payload_bytes 为记录的总字节数
+ *   记录 = [RecordHeader 16 字节][payload_bytes 字节内容]
+ *   画面记录的内容 = [FrameHeader 16 字节][编码后的像素]，其他记录的内容为 UTF-8 JSON 文本
+ *
+ * 像素编码为“变换 + 零游程”：关键帧逐行与左侧像素做差，差分帧与同一画面流的上一帧按字节异或，
+ * 变换后的字节序列由若干 [零字节个数 varint][字面量长度 varint][字面量] 组成。
+ * 静止或局部变化的画面异或后几乎全为零，压缩率很高，而编解码只是一次顺序遍历。
+ *
+ * 每个分块中各画面流的第一帧总是关键帧，因此从任意分块开始都能独立解码；
+ * 读取方只需遍历分块头即可建立时间索引。写入中途崩溃时只会丢失尚未写出的最后一个分块。
+ */
+namespace FlightLog {
+
+constexpr char MAGIC[8] = {'B', 'D', '2', 'F', 'L', 'I', 'G', 'H'};
+constexpr char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    int64_t wall_clock_us;  // 记录开始时的系统时间（Unix 微秒），仅供查看
+    uint64_t reserved2;
+};
+
+struct ChunkHeader {
+    char magic[4];
+    uint32_t record_count;
+    uint64_t payload_bytes;
+    int64_t first_us;  // 分块内记录时间戳的最小值与最大值
+    int64_t last_us;
+};
+
+struct RecordHeader {
+    uint8_t type;  // FlightRecordType
+    uint8_t reserved;
+    uint16_t stream;
+    uint32_t payload_bytes;
+    int64_t timestamp_us;
+};
+
+enum class Codec : uint8_t {
+    Key = 0,    // 与左侧像素做差
+    Delta = 1,  // 与上一帧异或
+};
+
+struct FrameHeader {
+    uint16_t width;
+    uint16_t height;
+    uint8_t channels;
+    uint8_t codec;  // Codec
+    uint16_t reserved;
+    int32_t x;  // 区域在客户区中的位置
+    int32_t y;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader 大小必须与文件格式一致");
+static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader 大小必须与文件格式一致");
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader 大小必须与文件格式一致");
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader 大小必须与文件格式一致");
+
+} // namespace FlightLog
+
+enum class FlightRecordType : uint8_t {
+    Frame = 1,      // 画面或画面中的一块区域
+    Detection = 2,  // 识别结果
+    Input = 3,      // 发出的输入动作
+    Event = 4,      // 其他事件，如开始、停止与错误
+};
+
+/**
+ * @brief 从飞行记录中读出的一条记录。
+ */
+struct FlightRecord {
+    FlightRecordType type = FlightRecordType::Event;
+    uint16_t stream = 0;                     // 画面流编号，同一任务的多个区域各占一个流
+    std::chrono::microseconds timestamp{0};  // 相对记录开始的单调时间
+    cv::Mat image;                           // 画面记录的像素，只在下一次 next 之前有效
+    cv::Point origin;                        // 画面记录的区域在客户区中的位置
+    json data;                               // 其他记录的内容
+};
+
+/**
+ * @brief 记录机器人看到的画面、识别结果与发出的输入，用于事后复盘失败的运行。
+ *
+ * record* 只把数据放入队列，编码与写文件都在后台线程完成：画面拷贝进复用的缓冲区，
+ * 或直接共享调用方的 FrameHandle，热循环中不做压缩也不等待磁盘。
+ * 后台线程来不及处理、队列已满时新记录被丢弃并计入 Stats::dropped，不会阻塞调用方。
+ * 所有 record* 方法都是线程安全的，可以分别在截图、识别与执行线程上调用。
+ */
+class FlightRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        size_t chunk_bytes = 4u << 20;                    // 分块编码后达到此大小时写出
+        std::chrono::milliseconds chunk_duration{1000};   // 分块跨越的最长时间，限制崩溃时丢失的记录
+        int keyframe_interval = 120;                      // 同一画面流每隔多少帧强制写一个关键帧
+        size_t queue_capacity = 64;                       // 等待后台线程处理的最大记录数
+    };
+
+    struct Stats {
+        uint64_t records = 0;        // 已写入文件的记录数
+        uint64_t dropped = 0;        // 队列已满而丢弃的记录数
+        uint64_t frames = 0;         // 已写入的画面数
+        uint64_t raw_bytes = 0;      // 画面编码前的字节数
+        uint64_t encoded_bytes = 0;  // 画面编码后的字节数
+        uint64_t chunks = 0;
+        bool failed = false;         // 写文件失败，之后的记录全部丢弃
+    };
+
+    explicit FlightRecorder(const std::string& path);
+
+    /**
+     * @throw FlightRecordException 无法创建文件。
+     */
+    FlightRecorder(const std::string& path, Options options);
+
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * @brief 记录一帧 8 位画面（1、3 或 4 通道），像素被拷贝进记录器的缓冲区。
+     * @param origin 区域在客户区中的位置，整窗画面为 (0, 0)。
+     * @return 队列已满、记录器已关闭或图像格式不受支持时返回 false。
+     */
+    bool recordFrame(const cv::Mat& image, uint16_t stream = 0, cv::Point origin = {}, Clock::time_point at = Clock::now());
+
+    /**
+     * @brief 同上，直接共享句柄中的像素而不拷贝。
+     */
+    bool recordFrame(FrameHandle frame, uint16_t stream = 0, cv::Point origin = {}, Clock::time_point at = Clock::now());
+
+    bool recordDetection(json data, uint16_t stream = 0, Clock::time_point at = Clock::now());
+    bool recordInput(json action, Clock::time_point at = Clock::now());
+    bool recordEvent(json event, Clock::time_point at = Clock::now());
+
+    /**
+     * @brief 写出队列中剩余的记录与最后一个分块并关闭文件，之后的 record* 全部失败。重复调用无效果。
+     */
+    void close();
+
+    Stats stats() const;
+    const std::string& path() const { return path_; }
+
+private:
+    struct Entry {
+        FlightRecordType type = FlightRecordType::Event;
+        uint16_t stream = 0;
+        int64_t timestamp_us = 0;
+        cv::Point origin;
+        FrameHandle frame;
+        json data;
+    };
+
+    // 画面流的编码状态，由后台线程独占
+    struct StreamState {
+        cv::Mat previous;  // 上一帧的连续拷贝，差分帧与之异或
+        int since_keyframe = 0;
+        bool needs_keyframe = true;
+    };
+
+    bool submit(Entry&& entry);
+    void writerLoop();
+    void append(const Entry& entry);
+    void appendFrame(const Entry& entry);
+    void writeChunk();
+
+    int64_t toMicros(Clock::time_point at) const;
+
+    const std::string path_;
+    const Options options_;
+    const Clock::time_point origin_;
+    std::ofstream out_;
+
+    FramePool pool_;
+    BoundedQueue<Entry> queue_;
+    std::thread writer_;
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> failed_{false};
+
+    // 以下由后台线程独占
+    std::vector<uint8_t> chunk_;
+    std::vector<uint8_t> scratch_;
+    FlightLog::ChunkHeader chunk_header_{};
+    std::map<uint16_t, StreamState> streams_;
+
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> raw_bytes_{0};
+    std::atomic<uint64_t> encoded_bytes_{0};
+    std::atomic<uint64_t> chunks_{0};
+};
+
+/**
+ * @brief 通过内存映射读取飞行记录。
+ *
+ * 打开时只遍历分块头建立时间索引，不解码记录；seek 定位到目标时间所在的分块，
+ * 从该分块的第一条记录开始解码。文件末尾不完整的分块（写入中途崩溃）会被忽略。
+ * 对象不是线程安全的。
+ */
+class FlightLogReader {
+public:
+    struct ChunkInfo {
+        size_t offset = 0;  // 分块中第一条记录的文件偏移
+        uint32_t record_count = 0;
+        uint64_t payload_bytes = 0;
+        std::chrono::microseconds first{0};
+        std::chrono::microseconds last{0};
+    };
+
+    /**
+     * @throw FlightRecordException 文件无法打开或不是飞行记录。
+     */
+    explicit FlightLogReader(const std::string& path);
+
+    FlightLogReader(const FlightLogReader&) = delete;
+    FlightLogReader& operator=(const FlightLogReader&) = delete;
+
+    const std::vector<ChunkInfo>& chunks() const { return chunks_; }
+    std::chrono::microseconds startTime() const;
+    std::chrono::microseconds endTime() const;
+
+    /**
+     * @brief 之后的 next 从时间戳不早于 timestamp 的第一条记录开始返回。
+     */
+    void seek(std::chrono::microseconds timestamp);
+
+    void rewind() { seek(std::chrono::microseconds::min()); }
+
+    /**
+     * @brief 读取下一条记录。
+     * @return 已到达末尾时返回 false。
+     * @throw FlightRecordException 记录内容损坏。
+     */
+    bool next(FlightRecord& record);
+
+private:
+    void startChunk(size_t index);
+    bool readRecord(FlightRecord& record);
+    void decodeFrame(const uint8_t* payload, size_t bytes, uint16_t stream, FlightRecord& record);
+
+    std::string path_;
+    MappedFile file_;
+    std::vector<ChunkInfo> chunks_;
+
+    size_t chunk_index_ = 0;
+    size_t offset_ = 0;            // 下一条记录的文件偏移
+    uint32_t records_left_ = 0;    // 当前分块中剩余的记录数
+    int64_t skip_before_us_ = 0;   // seek 目标之前的记录只解码、不返回
+    bool skipping_ = false;
+    std::map<uint16_t, cv::Mat> streams_;  // 各画面流最近解码的一帧，差分帧就地更新
+};
+
+/**
+ * @brief 把飞行记录中的一个画面流作为回放帧源，可以用 FrameSource::open 的 "flight" 类型打开。
+ * 4 通道与单通道的画面转换为 BGR。
+ */
+class FlightRecordSource : public RecordedFrameSource {
+public:
+    FlightRecordSource(const std::string& path, PlaybackOptions options, uint16_t stream = 0);
+
+    std::string describe() const override;
+
+protected:
+    bool readNext(cv::Mat& image, std::chrono::microseconds& timestamp) override;
+    bool rewind() override;
+
+private:
+    std::string path_;
+    uint16_t stream_;
+    FlightLogReader reader_;
+    FlightRecord record_;
+    bool has_first_ = false;
+    std::chrono::microseconds first_{0};
+};
+
+/**
+ * @brief 按时间顺序读出飞行记录中同一时刻的一组区域画面，用于回放只记录了若干区域的任务。
+ *
+ * 任务在同一时刻记录的各区域使用相同的时间戳，读取方据此把它们归为一组，
+ * 连同区域在客户区中的位置一起返回，回放时可以直接交给识别代码，不需要整窗画面。
+ * 缺少某个画面流的组（例如记录时队列已满丢弃了其中一帧）被整组跳过。
+ * 画面保持记录时的通道数，时间戳相对记录开始。对象不是线程安全的。
+ */
+class FlightRegionReader {
+public:
+    struct Regions {
+        std::chrono::microseconds timestamp{0};
+        std::vector<cv::Mat> images;     // 按构造时给出的画面流顺序排列，下一次 next 时就地覆盖
+        std::vector<cv::Point> origins;  // 各区域在客户区中的位置
+    };
+
+    /**
+     * @throw FlightRecordException 文件无法打开或不是飞行记录。
+     */
+    FlightRegionReader(const std::string& path, std::vector<uint16_t> streams);
+
+    FlightRegionReader(const FlightRegionReader&) = delete;
+    FlightRegionReader& operator=(const FlightRegionReader&) = delete;
+
+    /**
+     * @brief 读取下一组完整的区域画面。
+     * @return 已到达末尾时返回 false。
+     * @throw FlightRecordException 记录内容损坏。
+     */
+    bool next(Regions& regions);
+
+    std::string describe() const;
+
+private:
+    std::string path_;
+    std::vector<uint16_t> streams_;
+    FlightLogReader reader_;
+    FlightRecord record_;
+};
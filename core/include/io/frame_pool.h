@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+class FramePool;
+
+/**
+ * @brief 从 FramePool 借出的一帧，按引用计数共享。
+ *
+ * 拷贝句柄只增加引用计数，不拷贝像素；最后一个句柄析构时缓冲区归还给池，供之后的帧复用。
+ * 持有句柄期间缓冲区不会被改写。池只按句柄判断槽位是否在用，image() 的 cv::Mat 头
+ * 只在持有句柄期间有效；需要保留像素时应持有句柄本身，或拷贝进调用方自己的 Mat。
+ */
+class FrameHandle {
+public:
+    FrameHandle() = default;
+
+    explicit operator bool() const { return slot_ != nullptr; }
+
+    const cv::Mat& image() const { return slot_->image; }
+    std::chrono::microseconds timestamp() const { return slot_->timestamp; }
+    uint64_t index() const { return slot_->index; }
+
+    /**
+     * @brief 当前共享同一缓冲区的句柄数。
+     */
+    long useCount() const { return slot_.use_count(); }
+
+    /**
+     * @brief 供填充方在交出句柄之前就地写入的缓冲区，交出后只应通过 image() 读取。
+     */
+    cv::Mat& buffer() { return slot_->image; }
+
+private:
+    friend class FramePool;
+    friend class CaptureSession;
+
+    struct Slot {
+        cv::Mat image;
+        std::chrono::microseconds timestamp{0};
+        uint64_t index = 0;
+    };
+
+    explicit FrameHandle(std::shared_ptr<Slot> slot) : slot_(std::move(slot)) {}
+
+    Slot& slot() { return *slot_; }
+
+    std::shared_ptr<Slot> slot_;
+};
+
+/**
+ * @brief 固定数量的输出缓冲区环，截图会话借出后由 FrameHandle 自动归还。
+ *
+ * 槽位中的 cv::Mat 在整个生命周期内复用，写入方以 create/cvtColor/copyTo 等方式就地填充时，
+ * 只有尺寸或类型变化才会重新分配内存。所有槽位都被借出时临时分配一个额外槽位，
+ * 不会阻塞，也不会改写仍被持有的帧。池本身与平台无关，可以用回放帧源单独测试。
+ * 所有方法都是线程安全的，句柄可以在任意线程上释放，也可以比池活得更久。
+ */
+class FramePool {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 3;
+
+    struct Stats {
+        uint64_t acquired = 0;   // 借出次数
+        uint64_t overflows = 0;  // 所有槽位都被占用、临时分配的次数
+    };
+
+    explicit FramePool(size_t capacity = DEFAULT_CAPACITY);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief 借出一个空闲槽位。槽位保留上次使用时的缓冲区，由调用方就地填充。
+     */
+    FrameHandle acquire();
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief 当前空闲的槽位数。
+     */
+    size_t available() const;
+
+    Stats stats() const;
+
+private:
+    using Slot = FrameHandle::Slot;
+
+    // 句柄的删除器持有共享状态，池先于句柄析构时槽位仍然有效
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot>> slots;
+        std::vector<Slot*> free_slots;
+        Stats stats;
+    };
+
+    static void recycle(const std::shared_ptr<State>& state, Slot* slot);
+
+    const size_t capacity_;
+    std::shared_ptr<State> state_;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <opencv2/core/mat.hpp>
+
+#include "basic/logger.h"
+
+/**
+ * @brief 基于共享内存的帧环形缓冲区，用于向 GUI 提供零拷贝的实时预览。
+ *
+ * Linux 下使用 POSIX shm，Windows 下使用页面文件支持的文件映射。内存布局：
+ *
+ *   [RingHeader][SlotHeader 0][像素数据 0][SlotHeader 1][像素数据 1]...
+ *
+ * 每个槽位的起始偏移为 header_size + slot_index * slot_stride，
+ * 像素数据紧跟在 SlotHeader 之后（偏移 SLOT_HEADER_SIZE），按行紧密排列。
+ * 写入方式为单槽位序列锁：写入期间 sequence 为 0，写完后置为本帧的序号。
+ * 读取方应在拷贝前后各读一次 sequence，两次相同且等于通知中的序号时数据才有效。
+ */
+class FrameRing {
+public:
+    static constexpr char MAGIC[8] = {'B', 'D', '2', 'R', 'I', 'N', 'G', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t RING_HEADER_SIZE = 64;
+    static constexpr size_t SLOT_HEADER_SIZE = 64;
+
+    struct RingHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t slot_count;
+        uint64_t slot_capacity;     // 每个槽位可容纳的像素字节数
+        uint64_t slot_stride;       // 相邻槽位起始位置的字节间隔
+        std::atomic<uint64_t> latest_sequence;
+    };
+
+    struct SlotHeader {
+        std::atomic<uint64_t> sequence;
+        uint64_t timestamp_us;      // steady_clock 微秒时间戳
+        uint32_t width;
+        uint32_t height;
+        uint32_t channels;
+        uint32_t stride;            // 每行字节数
+    };
+
+    static_assert(sizeof(RingHeader) <= RING_HEADER_SIZE, "RingHeader 超出预留空间");
+    static_assert(sizeof(SlotHeader) <= SLOT_HEADER_SIZE, "SlotHeader 超出预留空间");
+
+    struct PublishedFrame {
+        uint32_t slot;
+        uint64_t sequence;
+        uint64_t offset;            // 像素数据相对映射起点的偏移
+        int width;
+        int height;
+        int channels;
+        int stride;
+    };
+
+    /**
+     * @brief 创建（或重新创建）一个命名的共享内存环。
+     * @throws SharedMemoryException 创建或映射失败时抛出。
+     */
+    FrameRing(std::string name, uint32_t slot_count, size_t slot_capacity);
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    /**
+     * @brief 将一帧 8 位图像写入下一个槽位。超过槽位容量的图像会被等比缩小。
+     * @return 写入的位置信息；图像为空或格式不支持时返回 std::nullopt。
+     */
+    std::optional<PublishedFrame> publish(const cv::Mat& image);
+
+    const std::string& name() const { return name_; }
+    size_t mappedSize() const { return mapped_size_; }
+
+private:
+    std::string name_;
+    uint32_t slot_count_;
+    size_t slot_capacity_;
+    size_t slot_stride_;
+    size_t mapped_size_;
+
+    void* mapping_handle_ = nullptr;   // Windows 下为 HANDLE
+    int shm_fd_ = -1;                  // POSIX 下的 shm 文件描述符
+    unsigned char* base_ = nullptr;
+
+    std::mutex publish_mutex_;
+    uint64_t next_sequence_ = 1;
+
+    RingHeader* header() const;
+    SlotHeader* slotHeader(uint32_t slot) const;
+    unsigned char* slotData(uint32_t slot) const;
+};
+
+/**
+ * @brief 进程内共享的预览通道。
+ *
+ * 任务线程调用 publish 把调试画面写入共享内存环，并通过 Logger 发出一条
+ * "frame/preview" 通知，通知中只包含槽位、尺寸与序号，不包含像素数据。
+ * GUI 通过 app/subscribePreview 声明自己在读取预览；没有订阅者时 publish 直接返回，
+ * 不拷贝像素也不发通知，任务可以先检查 subscribed 再决定是否绘制预览画面。
+ */
+namespace FramePreview {
+
+// 预览共享内存的名称与容量。槽位容量可容纳一帧 1920x1080 的 BGRA 图像
+inline const char* RING_NAME = "bd2_auto_preview";
+constexpr uint32_t RING_SLOT_COUNT = 3;
+constexpr size_t RING_SLOT_CAPACITY = 1920 * 1080 * 4;
+
+/**
+ * @brief 设置是否有订阅者读取预览，由 app/subscribePreview 调用。
+ */
+void setSubscribed(bool subscribed);
+
+bool subscribed();
+
+/**
+ * @brief 发布一帧预览。
+ * @param source 画面来源名称，供 GUI 区分不同的预览窗口。
+ * @return 发布成功返回 true；没有订阅者时返回 false；共享内存不可用时只在第一次失败时记录警告。
+ */
+bool publish(const cv::Mat& image, const std::string& source, const Logger& logger);
+
+} // namespace FramePreview
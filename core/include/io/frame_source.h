@@ -0,0 +1,250 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "nlohmann/json.hpp"
+#include "io/backend.h"
+#include "io/mapped_file.h"
+
+using json = nlohmann::json;
+
+/**
+ * @brief 帧源产出的一帧。
+ */
+struct SourceFrame {
+    cv::Mat image;                       // BGR，CV_8UC3
+    std::chrono::microseconds timestamp; // 相对流起点的时间，回放时为录制时间
+    uint64_t index = 0;                  // 从 0 开始的帧序号，循环回放时继续递增
+};
+
+/**
+ * @brief 图像帧的来源：实时窗口截图，或用于离线回放的录制文件。
+ *
+ * 视觉代码只依赖此接口，不关心画面来自游戏还是文件，因此可以在没有游戏的环境下
+ * 运行、测量与回归测试。同一个帧源只能由一个线程使用。
+ */
+class IFrameSource {
+public:
+    virtual ~IFrameSource() = default;
+
+    /**
+     * @brief 取下一帧。frame.image 只保证在下一次 grab 之前有效，需要保留时应 clone。
+     * @return 流已结束，或按录制节奏等待期间收到停止请求时返回 false。
+     * @throw ScreenshotFailedException 实时截图失败。
+     */
+    virtual bool grab(SourceFrame& frame) = 0;
+
+    /**
+     * @brief 是否为游戏的实时画面。回放源的画面不对应真实窗口，不应据此发送输入。
+     */
+    virtual bool isLive() const = 0;
+
+    virtual std::string describe() const = 0;
+};
+
+/**
+ * @brief 游戏窗口的实时截图，使用 Screenshot 的对应后端。
+ *
+ * GDI 表面在多次 grab 之间复用；frame.image 的尺寸与上一帧相同时截图就地写入其中。
+ */
+class LiveFrameSource : public IFrameSource {
+public:
+    explicit LiveFrameSource(IOBackend::Mode backend = IOBackend::Mode::WindowMessage);
+    ~LiveFrameSource() override;
+
+    LiveFrameSource(const LiveFrameSource&) = delete;
+    LiveFrameSource& operator=(const LiveFrameSource&) = delete;
+
+    bool grab(SourceFrame& frame) override;
+    bool isLive() const override { return true; }
+    std::string describe() const override;
+
+private:
+    struct Surface;  // 平台相关的截图表面，定义在 screenshot.cpp
+
+    IOBackend::Mode backend_;
+    std::unique_ptr<Surface> surface_;
+    std::chrono::steady_clock::time_point started_at_{};
+    uint64_t next_index_ = 0;
+};
+
+/**
+ * @brief 录制回放的节奏。
+ */
+struct PlaybackOptions {
+    enum class Pacing {
+        Recorded,  // 按录制时间戳回放，用于复现真实时序
+        Fastest,   // 不等待，尽快产出，用于基准测试与回归测试
+    };
+
+    Pacing pacing = Pacing::Recorded;
+    bool loop = false;  // 到达末尾后从头开始，时间戳继续递增
+};
+
+/**
+ * @brief 文件回放源的公共部分：按 PlaybackOptions 控制节奏与循环。
+ *
+ * 按录制节奏等待时使用当前线程绑定的 StopToken，停止请求会立即打断回放。
+ */
+class RecordedFrameSource : public IFrameSource {
+public:
+    bool grab(SourceFrame& frame) final;
+    bool isLive() const final { return false; }
+
+protected:
+    explicit RecordedFrameSource(PlaybackOptions options) : options_(options) {}
+
+    /**
+     * @brief 读取下一帧及其录制时间戳（相对第一帧）。
+     * @return 已到达末尾返回 false。
+     */
+    virtual bool readNext(cv::Mat& image, std::chrono::microseconds& timestamp) = 0;
+
+    /**
+     * @brief 回到第一帧，失败时返回 false，回放随之结束。
+     */
+    virtual bool rewind() = 0;
+
+private:
+    PlaybackOptions options_;
+    bool started_ = false;
+    std::chrono::steady_clock::time_point origin_{};  // 录制时间 0 对应的回放时刻
+    std::chrono::microseconds loop_offset_{0};        // 之前各轮回放的累计时长
+    std::chrono::microseconds last_timestamp_{0};     // 本轮最后一帧的录制时间
+    std::chrono::microseconds frame_interval_{0};     // 最近两帧的间隔，用于衔接下一轮
+    uint64_t next_index_ = 0;
+};
+
+/**
+ * @brief 目录中按文件名排序的 PNG 序列。
+ *
+ * 目录中存在 timestamps.txt 时，按行读取每帧的录制时间（毫秒，可为小数），
+ * 行数少于图片数时多出的图片被忽略；否则按固定帧率 fps 推算时间戳。
+ */
+class PngSequenceSource : public RecordedFrameSource {
+public:
+    PngSequenceSource(const std::string& directory, PlaybackOptions options, double fps = 30.0);
+
+    std::string describe() const override;
+    size_t frameCount() const { return files_.size(); }
+
+protected:
+    bool readNext(cv::Mat& image, std::chrono::microseconds& timestamp) override;
+    bool rewind() override;
+
+private:
+    std::string directory_;
+    std::vector<std::string> files_;
+    std::vector<std::chrono::microseconds> timestamps_;
+    size_t position_ = 0;
+};
+
+/**
+ * @brief 通过 cv::VideoCapture 读取的视频文件，时间戳取自容器中的播放位置。
+ */
+class VideoFileSource : public RecordedFrameSource {
+public:
+    VideoFileSource(const std::string& path, PlaybackOptions options);
+
+    std::string describe() const override;
+
+protected:
+    bool readNext(cv::Mat& image, std::chrono::microseconds& timestamp) override;
+    bool rewind() override;
+
+private:
+    std::string path_;
+    cv::VideoCapture capture_;
+    double fps_ = 30.0;
+    uint64_t position_ = 0;
+};
+
+/**
+ * @brief 原始帧转储文件，通过内存映射读取，BGR 帧直接引用映射内存而不拷贝。
+ *
+ * 文件格式（小端）：
+ *
+ *   [FileHeader 32 字节][记录 0][记录 1]...
+ *   记录 = [int64 录制时间戳（微秒）][height * width * channels 字节像素，按行紧密排列]
+ *
+ * 所有帧尺寸相同，第 i 帧位于 FILE_HEADER_SIZE + i * (8 + 帧字节数)，帧数由文件大小推出。
+ * channels 为 3（BGR）或 4（BGRA，读取时就地转换进 frame.image）。文件由 RawFrameDumpWriter 生成。
+ */
+class RawDumpSource : public RecordedFrameSource {
+public:
+    static constexpr char MAGIC[8] = {'B', 'D', '2', 'D', 'U', 'M', 'P', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t FILE_HEADER_SIZE = 32;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t channels;
+        uint64_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == FILE_HEADER_SIZE, "FileHeader 大小必须与文件格式一致");
+
+    RawDumpSource(const std::string& path, PlaybackOptions options);
+
+    std::string describe() const override;
+    size_t frameCount() const { return frame_count_; }
+
+protected:
+    bool readNext(cv::Mat& image, std::chrono::microseconds& timestamp) override;
+    bool rewind() override;
+
+private:
+    std::string path_;
+    MappedFile file_;          // 写时复制映射，调用方修改帧不会影响文件
+    uint8_t* data_ = nullptr;  // file_ 的起始地址
+    FileHeader header_{};
+    size_t frame_bytes_ = 0;
+    size_t frame_count_ = 0;
+    size_t position_ = 0;
+};
+
+/**
+ * @brief 生成 RawDumpSource 可读取的转储文件，第一帧决定整个文件的尺寸与通道数。
+ */
+class RawFrameDumpWriter {
+public:
+    explicit RawFrameDumpWriter(const std::string& path);
+
+    /**
+     * @brief 追加一帧。尺寸或通道数与第一帧不同时抛出 FrameSourceException。
+     */
+    void write(const cv::Mat& image, std::chrono::microseconds timestamp);
+
+    size_t framesWritten() const { return frames_written_; }
+
+private:
+    std::string path_;
+    std::ofstream out_;
+    RawDumpSource::FileHeader header_{};
+    size_t frames_written_ = 0;
+};
+
+namespace FrameSource {
+
+/**
+ * @brief 按描述创建帧源：
+ *   {"type": "live" | "png_dir" | "video" | "raw_dump" | "flight",
+ *    "path": 文件或目录, "backend": 实时截图后端,
+ *    "pacing": "recorded" | "fastest", "loop": false, "fps": PNG 序列无时间戳时的帧率,
+ *    "stream": 飞行记录中回放的画面流}
+ * @throw FrameSourceException 描述无效或文件无法打开。
+ */
+std::shared_ptr<IFrameSource> open(const json& spec);
+
+} // namespace FrameSource
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 把整个文件映射到内存，析构时解除映射。
+ *
+ * 录制文件的读取方通过映射按需访问任意位置，不必先把文件读进内存。
+ */
+class MappedFile {
+public:
+    enum class Mode {
+        ReadOnly,
+        CopyOnWrite,  // 可写的私有映射，修改只影响本进程，不写回文件
+    };
+
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief 映射 path，已有的映射会先被解除。
+     * @return 文件不存在、为空或映射失败时返回 false。
+     */
+    bool open(const std::string& path, Mode mode);
+
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
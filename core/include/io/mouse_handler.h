@@ -10,6 +10,7 @@ void click_in_rect_with_win32(const cv::Rect& target_rect, bool instant_move = t
 
 void click_in_rect_with_window_message(const cv::Rect& target_rect, bool instant_move = true);
 
+// 以下两个按后端分派的函数在动作完成后调用 FrameTrace::inputInjected，记到当前线程绑定的帧
 void click_in_rect_with_backend(const cv::Rect& target_rect, IOBackend::Mode backend = IOBackend::Mode::WindowMessage, bool instant_move = true);
 
 void drag_with_win32(const cv::Rect& start_rect, const cv::Rect& end_rect, bool instant_move = false);
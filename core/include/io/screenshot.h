@@ -1,18 +1,76 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <opencv2/core/mat.hpp>
 #include <opencv2/opencv.hpp>
 
 #include "io/backend.h"
+#include "io/frame_pool.h"
+
+class IFrameSource;
 
+/**
+ * @brief 每次成功的截图（含帧源取帧与区域截图）都通过 FrameTrace::captured 分配帧序号并记录开始时刻，
+ * 之后本线程经 UIAutomator 发出的输入动作据此计算截图到输入的端到端延迟。
+ */
 namespace Screenshot {
 
 cv::Mat capture_with_win32();
 
 cv::Mat capture_with_window_message();
 
+/**
+ * @brief 按后端截取游戏窗口；设置了帧源时改为从帧源取下一帧，不访问游戏窗口。
+ * @throw ScreenshotFailedException 截图失败或帧源已结束。
+ */
 cv::Mat capture_with_backend(IOBackend::Mode backend = IOBackend::Mode::WindowMessage);
 
+/**
+ * @brief 同 capture_with_backend，但以 BGRA（CV_8UC4）返回，直接读出位图而不做整帧颜色转换。
+ * UIAutomator 的 verify/find 接受 BGRA 画面，只转换实际参与比较的区域。
+ * 设置了帧源时把帧源的 BGR 画面转换为 BGRA。
+ * @throw ScreenshotFailedException 截图失败或帧源已结束。
+ */
+cv::Mat capture_bgra(IOBackend::Mode backend = IOBackend::Mode::WindowMessage);
+
+/**
+ * @brief 替换 capture_with_backend 的画面来源，例如用录制文件离线运行视觉代码。
+ * 传入 nullptr 恢复实时截图。多个线程同时截图时依次从同一帧源取帧。
+ */
+void set_frame_source(std::shared_ptr<IFrameSource> source);
+
+std::shared_ptr<IFrameSource> frame_source();
+
+/**
+ * @brief 区域截图的选项。
+ */
+struct RegionCaptureOptions {
+    // WindowMessage：PrintWindow 绘制整个客户区后只读出区域内的像素，窗口可以在后台；
+    // Win32：直接从屏幕拷贝各区域，窗口不在前台时先激活，要求窗口未被遮挡
+    IOBackend::Mode backend = IOBackend::Mode::WindowMessage;
+    bool bgra = false;  // 输出 BGRA（CV_8UC4），省去颜色转换；默认输出 BGR（CV_8UC3）
+};
+
+/**
+ * @brief 一次截图中只读出 regions（客户区坐标）内的像素，供只关心小区域的任务使用。
+ * 设置了帧源时从帧源的下一帧裁出同样的区域。
+ *
+ * 耗时记录在 capture.regions，读出的像素数与整窗截图一起累计在 capture.pixels。
+ * @param outputs 调整为与 regions 等长；outputs[i] 的尺寸与格式不变时就地写入，不分配内存。
+ * @throw ScreenshotFailedException 截图失败、区域超出客户区或帧源已结束。
+ * @throw WindowException 找不到游戏窗口。
+ */
+void capture_regions(const std::vector<cv::Rect>& regions, std::vector<cv::Mat>& outputs,
+    const RegionCaptureOptions& options = {});
+
+/**
+ * @brief 同上，第 i 个区域写入从 pool 借出的第 i 个句柄。
+ */
+std::vector<FrameHandle> capture_regions(const std::vector<cv::Rect>& regions, FramePool& pool,
+    const RegionCaptureOptions& options = {});
+
 inline cv::Mat capture() {
     return capture_with_backend();
 }
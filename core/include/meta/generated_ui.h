@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <opencv2/core/types.hpp>
 
 namespace UILayouts {
@@ -13,6 +15,9 @@ struct Metadata {
 };
 
 
+// 全部元素，按生成顺序排列
+inline const std::array<const Metadata*, 0> ALL = {};
+
 } // namespace UILayouts
 
 namespace UITemplates {
@@ -25,4 +30,7 @@ struct Metadata {
 };
 
 
+// 全部元素，按生成顺序排列
+inline const std::array<const Metadata*, 0> ALL = {};
+
 } // namespace UITemplates
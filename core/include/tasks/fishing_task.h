@@ -12,5 +12,4 @@ private:
 
 public:
     explicit FishingTask(std::string name);
-    ~FishingTask() override = default;
 };
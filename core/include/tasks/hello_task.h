@@ -1,10 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/types.hpp>
 
+#include <meta/generated_ui.h>
+
 #include "basic/threaded_task.h"
 
 class HelloTask : public ThreadedTask {
@@ -28,14 +31,24 @@ private:
 
     bool step_setupWindow();
     bool step_waitABit();
-    bool step_shotBefore();
+    StepResult step_shotBefore();
     bool step_testInput();
-    bool step_shotAfter();
+    StepResult step_shotAfter();
     bool step_benchmarkCapture();
     bool step_showImage();
     bool step_cleanup();
 
+    /**
+     * @brief 反复截图直到布局验证通过或找到模板，命中时把测试点击区域改为命中的位置。
+     * @return 收到停止请求时返回 false；超时不视为失败。
+     */
+    bool waitForTarget(
+        const UILayouts::Metadata* layout,
+        const UITemplates::Metadata* template_,
+        std::chrono::milliseconds timeout
+    );
+
 public:
     explicit HelloTask(std::string name);
-    ~HelloTask() override = default;
+    ~HelloTask() override;
 };
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "basic/threaded_task.h"
+
+/**
+ * @brief 只读的游戏窗口状态监视任务。
+ *
+ * 按固定间隔检查窗口是否存在、是否最小化、是否在前台以及客户区尺寸，
+ * 状态变化时更新任务状态，并写入 window.* 指标。不占用输入与前台窗口，
+ * 可以与其他任务同时运行。
+ *
+ * 启动参数：{"interval_ms": 采样间隔，默认 1000，最小 100}
+ */
+class WindowMonitorTask : public ThreadedTask {
+private:
+    enum WindowMonitorTaskSteps : StepId {
+        WATCH
+    };
+
+    bool step_watch();
+
+public:
+    explicit WindowMonitorTask(std::string name);
+};
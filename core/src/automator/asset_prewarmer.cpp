@@ -0,0 +1,94 @@
+#include "automator/asset_prewarmer.h"
+
+#include "automator/ui_automator.h"
+#include "basic/json_rpc.h"
+
+AssetPrewarmer::~AssetPrewarmer() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool AssetPrewarmer::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == State::Running) {
+        return false;
+    }
+    // 上一次预热的线程已经结束，回收后再启动新的一轮
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    state_ = State::Running;
+    done_ = total_ = loaded_ = failed_ = 0;
+    started_at_ = std::chrono::steady_clock::now();
+    elapsed_ = {};
+    thread_ = std::thread(&AssetPrewarmer::run, this);
+    return true;
+}
+
+json AssetPrewarmer::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statusLocked();
+}
+
+json AssetPrewarmer::statusLocked() const {
+    const char* state_name = "idle";
+    auto elapsed = elapsed_;
+    if (state_ == State::Running) {
+        state_name = "running";
+        elapsed = std::chrono::steady_clock::now() - started_at_;
+    } else if (state_ == State::Done) {
+        state_name = "done";
+    }
+    return {
+        {"state", state_name},
+        {"done", done_},
+        {"total", total_},
+        {"loaded", loaded_},
+        {"failed", failed_},
+        {"elapsed_ms", std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()}
+    };
+}
+
+void AssetPrewarmer::run() {
+    auto last_report = std::chrono::steady_clock::now();
+
+    const auto result = UIAutomator::prewarm([&](size_t done, size_t total, const char* name, bool ok) {
+        json progress;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ = done;
+            total_ = total;
+            if (ok) {
+                ++loaded_;
+            } else {
+                ++failed_;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_report < PROGRESS_INTERVAL) {
+                return;
+            }
+            last_report = now;
+            progress = statusLocked();
+        }
+        progress["current"] = name;
+        progress["finished"] = false;
+        JsonRpc::sendNotification("prewarm/progress", progress);
+    });
+
+    json progress;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = result.loaded + result.failed;
+        total_ = result.total;
+        loaded_ = result.loaded;
+        failed_ = result.failed;
+        elapsed_ = std::chrono::steady_clock::now() - started_at_;
+        state_ = State::Done;
+        progress = statusLocked();
+    }
+    progress["finished"] = true;
+    progress["message"] = "资源预热完成：已加载 " + std::to_string(result.loaded) + " 个，失败 "
+        + std::to_string(result.failed) + " 个。";
+    JsonRpc::sendNotification("prewarm/progress", progress);
+}
@@ -0,0 +1,90 @@
+#include "automator/screen_context.h"
+
+#include "basic/metrics.h"
+
+namespace {
+
+Metrics::Counter& cache_hits() {
+    static auto& counter = Metrics::instance().counter("automator.cache_hits");
+    return counter;
+}
+
+Metrics::Counter& cache_misses() {
+    static auto& counter = Metrics::instance().counter("automator.cache_misses");
+    return counter;
+}
+
+} // namespace
+
+UIAutomator::ScreenContext::ScreenContext(Matcher matcher, int tile_size)
+    : matcher_(std::move(matcher)), tiles_(tile_size) {}
+
+void UIAutomator::ScreenContext::update(const cv::Mat& screen) {
+    screen_ = screen;
+    tiles_.update(screen);
+}
+
+void UIAutomator::ScreenContext::clear() {
+    layouts_.clear();
+    templates_.clear();
+}
+
+bool UIAutomator::ScreenContext::verify(const UILayouts::Metadata& layout, double confidence) {
+    auto it = layouts_.find(layout.filename);
+    if (it != layouts_.end() && it->second.confidence == confidence
+        && !tiles_.changedSince(layout.location, it->second.frame)) {
+        cache_hits().add();
+        return it->second.location.has_value();
+    }
+
+    cache_misses().add();
+    const bool matched = matcher_.verify(screen_, layout, confidence);
+    CachedResult& cached = layouts_[layout.filename];
+    cached.frame = tiles_.frame();
+    cached.confidence = confidence;
+    cached.location = matched ? std::optional<cv::Rect>(layout.location) : std::nullopt;
+    return matched;
+}
+
+std::optional<cv::Rect> UIAutomator::ScreenContext::find(const UITemplates::Metadata& template_, double confidence) {
+    auto it = templates_.find(template_.filename);
+    const bool reusable = it != templates_.end() && it->second.confidence == confidence && tiles_.frame() > 0;
+    const cv::Rect screen_rect(0, 0, screen_.cols, screen_.rows);
+    std::optional<cv::Rect> location;
+
+    if (reusable && it->second.location) {
+        // 上次命中的位置未变化时匹配分数不变，沿用该位置
+        if (!tiles_.changedSince(*it->second.location, it->second.frame)) {
+            cache_hits().add();
+            it->second.frame = tiles_.frame();
+            return it->second.location;
+        }
+        cache_misses().add();
+        location = matcher_.find(screen_, screen_rect, template_, confidence);
+    } else if (reusable) {
+        // 上次未命中：未变化的位置分数仍低于阈值，只需搜索窗口与变化区域相交的位置
+        const cv::Rect changed = tiles_.changedBoundsSince(it->second.frame);
+        if (changed.empty()) {
+            cache_hits().add();
+            it->second.frame = tiles_.frame();
+            return std::nullopt;
+        }
+        cache_misses().add();
+        const cv::Size size = matcher_.template_size(template_);
+        if (size.empty()) {
+            return std::nullopt;
+        }
+        const cv::Rect search = cv::Rect(changed.x - size.width + 1, changed.y - size.height + 1,
+            changed.width + 2 * (size.width - 1), changed.height + 2 * (size.height - 1)) & screen_rect;
+        location = matcher_.find(screen_, search, template_, confidence);
+    } else {
+        cache_misses().add();
+        location = matcher_.find(screen_, screen_rect, template_, confidence);
+    }
+
+    CachedResult& cached = templates_[template_.filename];
+    cached.frame = tiles_.frame();
+    cached.confidence = confidence;
+    cached.location = location;
+    return location;
+}
@@ -2,11 +2,137 @@
 #include <meta/generated_ui.h>
 #include <basic/base_config.h>
 #include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include "io/mouse_handler.h"
+#include "basic/frame_trace.h"
 #include "basic/path_util.hpp"
+#include "cv/point_matcher.h"
 
-static std::map<std::string, cv::Mat> layout_cache;
-static std::map<std::string, cv::Mat> template_cache;
+namespace {
+
+// 预热线程与任务线程会并发访问缓存，查找只需共享锁
+std::shared_mutex cache_mutex;
+std::unordered_map<std::string, cv::Mat> layout_cache;
+std::unordered_map<std::string, cv::Mat> template_cache;
+
+cv::Mat load_layout(const UILayouts::Metadata& layout) {
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_mutex);
+        auto it = layout_cache.find(layout.filename);
+        if (it != layout_cache.end()) {
+            return it->second;
+        }
+    }
+
+    // 动态构建模板的完整路径
+    std::filesystem::path full_template_path = get_executable_directory()
+        .append(BaseConfig::ASSETS_LAYOUTS_PATH).append(layout.filename);
+    cv::Mat layout_img = cv::imread(full_template_path.string(), cv::IMREAD_COLOR);
+    if (layout_img.empty()) {
+        return {};
+    }
+
+    // 布局图是整屏大小。验证时截图区域在整张布局图上滑动取最高分，
+    // 因此布局图不裁剪，位置略有偏差的布局仍能通过验证
+    const cv::Rect image_rect(0, 0, layout_img.cols, layout_img.rows);
+    if ((layout.location & image_rect) != layout.location) {
+        return {};
+    }
+
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    return layout_cache.emplace(layout.filename, std::move(layout_img)).first->second;
+}
+
+cv::Mat load_template(const UITemplates::Metadata& template_) {
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_mutex);
+        auto it = template_cache.find(template_.filename);
+        if (it != template_cache.end()) {
+            return it->second;
+        }
+    }
+
+    std::filesystem::path full_path = get_executable_directory()
+        .append(BaseConfig::ASSETS_TEMPLATES_PATH)
+        .append(template_.filename);
+    cv::Mat template_img = cv::imread(full_path.string(), cv::IMREAD_COLOR);
+    if (template_img.empty()) {
+        return {};
+    }
+
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    return template_cache.emplace(template_.filename, std::move(template_img)).first->second;
+}
+
+// 模板在加载时即为 BGR。BGRA 画面只把参与比较的区域转换为 BGR，不转换整帧；
+// 转换结果写入线程内复用的缓冲区，只在下一次调用之前有效
+cv::Mat as_bgr(const cv::Mat& image) {
+    if (image.channels() != 4) {
+        return image;
+    }
+    thread_local cv::Mat converted;
+    cv::cvtColor(image, converted, cv::COLOR_BGRA2BGR);
+    return converted;
+}
+
+// 在 image 中查找模板，返回 image 坐标系下的最佳匹配
+std::optional<cv::Rect> match_template(const cv::Mat& image, const cv::Mat& template_img, double confidence) {
+    if (template_img.cols > image.cols || template_img.rows > image.rows) {
+        return std::nullopt;
+    }
+
+    // 模板匹配
+    cv::Mat result;
+    // 匹配方法结果范围在-1到1之间
+    cv::matchTemplate(as_bgr(image), template_img, result, cv::TM_CCOEFF_NORMED);
+
+    // 获取匹配结果的最高分及其位置
+    double minVal, maxVal;
+    cv::Point minLoc, maxLoc;
+    cv::minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+
+    // 最高分与传入的相似度阈值比较
+    if (maxVal >= confidence) {
+        return cv::Rect(maxLoc.x, maxLoc.y, template_img.cols, template_img.rows);
+    }
+
+    // 未找到满足置信度的匹配项
+    return std::nullopt;
+}
+
+// 把输入动作记到本线程最近一次截图的帧上。detected 表示动作之前刚完成了一次识别，
+// 此时识别与决策的分界记为同一时刻；调用方已绑定 FrameTrace 时不重新绑定
+template <typename Action>
+void inject_for_last_capture(bool detected, Action&& action) {
+    if (FrameTrace::bound()) {
+        action();
+        return;
+    }
+    FrameTrace trace = FrameTrace::lastCaptured();
+    if (detected) {
+        trace.mark(FrameTrace::DETECT);
+    }
+    trace.mark(FrameTrace::DECIDE);
+    FrameTrace::Binding binding(trace);
+    action();
+}
+
+} // namespace
+
+void UIAutomator::click_in_rect(const cv::Rect& target_rect, IOBackend::Mode backend, bool instant_move) {
+    inject_for_last_capture(false, [&] {
+        MouseHandler::click_in_rect_with_backend(target_rect, backend, instant_move);
+    });
+}
+
+void UIAutomator::drag(const cv::Rect& start_rect, const cv::Rect& end_rect, IOBackend::Mode backend, bool instant_move) {
+    inject_for_last_capture(false, [&] {
+        MouseHandler::drag_with_backend(start_rect, end_rect, backend, instant_move);
+    });
+}
 
 bool UIAutomator::verify(const cv::Mat& screen, const UILayouts::Metadata& layout, double confidence) {
     // 边界检查
@@ -16,27 +142,16 @@ bool UIAutomator::verify(const cv::Mat& screen, const UILayouts::Metadata& layou
     }
 
     // 从缓存或文件加载模板图像
-    cv::Mat layout_img;
-    auto it = layout_cache.find(layout.filename);
-    if (it != layout_cache.end()) {
-        layout_img = it->second;
-    } else {
-        // 动态构建模板的完整路径
-        std::filesystem::path full_template_path = get_executable_directory()
-            .append(BaseConfig::ASSETS_LAYOUTS_PATH).append(layout.filename);
-        layout_img = cv::imread(full_template_path.string(), cv::IMREAD_COLOR);
-        if (layout_img.empty()) {
-            // 如果模板文件加载失败，无法进行验证
-            return false;
-        }
-        // 存入缓存
-        layout_cache[layout.filename] = layout_img;
+    cv::Mat layout_img = load_layout(layout);
+    if (layout_img.empty()) {
+        // 如果模板文件加载失败，无法进行验证
+        return false;
     }
 
     // 从屏幕截图中裁剪出要比较的区域
-    cv::Mat roi = screen(layout.location);
+    cv::Mat roi = as_bgr(screen(layout.location));
     
-    // 执行模板匹配
+    // 执行模板匹配。区域小于布局图，matchTemplate 让区域在整张布局图上滑动
     cv::Mat result;
     // 匹配方法结果范围在-1到1之间
     cv::matchTemplate(roi, layout_img, result, cv::TM_CCOEFF_NORMED);
@@ -53,7 +168,9 @@ bool UIAutomator::verify(const cv::Mat& screen, const UILayouts::Metadata& layou
 bool UIAutomator::verify_click(const cv::Mat& screen, const UILayouts::Metadata& layout, double confidence, IOBackend::Mode backend, bool instant_move) {
     // 先验证，如果成功，再行动。
     if (verify(screen, layout, confidence)) {
-        click_in_rect(layout.location, backend, instant_move);
+        inject_for_last_capture(true, [&] {
+            MouseHandler::click_in_rect_with_backend(layout.location, backend, instant_move);
+        });
         return true;
     }
     
@@ -61,70 +178,84 @@ bool UIAutomator::verify_click(const cv::Mat& screen, const UILayouts::Metadata&
     return false;
 }
 
-std::optional<cv::Rect> UIAutomator::find(const cv::Mat& screen, const UITemplates::Metadata& template_, double confidence) {
+std::optional<cv::Rect> UIAutomator::find(const cv::Mat& screen, const UITemplates::Metadata& template_, double confidence, const cv::Rect& search) {
     // 检查输入图像
     if (screen.empty()) {
         return std::nullopt;
     }
 
     // 从缓存或文件加载模板图像
-    cv::Mat template_img;
-    auto it = template_cache.find(template_.filename);
-    if (it != template_cache.end()) {
-        // 从缓存命中
-        template_img = it->second;
-    } else {
-        // 从文件加载
-        std::filesystem::path full_path = get_executable_directory()
-            .append(BaseConfig::ASSETS_TEMPLATES_PATH)
-            .append(template_.filename);
-
-        template_img = cv::imread(full_path.string(), cv::IMREAD_COLOR);
-        if (template_img.empty()) {
-            return std::nullopt;
-        }
-        // 成功加载后，存入缓存
-        template_cache[template_.filename] = template_img;
-    }
-
-    // 进行边界检查，确保模板不大于屏幕
-    if (template_img.cols > screen.cols || template_img.rows > screen.rows) {
+    cv::Mat template_img = load_template(template_);
+    if (template_img.empty()) {
         return std::nullopt;
     }
 
-    // 模板匹配
-    cv::Mat result;
-    // 匹配方法结果范围在-1到1之间
-    cv::matchTemplate(screen, template_img, result, cv::TM_CCOEFF_NORMED);
-
-    // 获取匹配结果的最高分及其位置
-    double minVal, maxVal;
-    cv::Point minLoc, maxLoc;
-    cv::minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
-
-    // 最高分与传入的相似度阈值比较
-    if (maxVal >= confidence) {
-        return cv::Rect(maxLoc.x, maxLoc.y, template_img.cols, template_img.rows);
+    // 只在搜索区域内匹配，BGRA 画面也只转换这一区域；模板大于搜索区域时直接视为未找到
+    const cv::Rect screen_rect(0, 0, screen.cols, screen.rows);
+    const cv::Rect region = search.empty() ? screen_rect : (search & screen_rect);
+    std::optional<cv::Rect> location = match_template(screen(region), template_img, confidence);
+    if (location) {
+        location->x += region.x;
+        location->y += region.y;
     }
-
-    // 未找到满足置信度的匹配项
-    return std::nullopt;
-
+    return location;
 }
 
-bool UIAutomator::find_click(const cv::Mat& screen, const UITemplates::Metadata& template_, double confidence, IOBackend::Mode backend, bool instant_move) {
+bool UIAutomator::find_click(const cv::Mat& screen, const UITemplates::Metadata& template_, double confidence, IOBackend::Mode backend, bool instant_move, const cv::Rect& search) {
     // 定位模板
-    auto found_location = find(screen, template_, confidence);
+    auto found_location = find(screen, template_, confidence, search);
 
     if (found_location) {
         // 解包 cv::Rect
         const cv::Rect& rect = *found_location;
 
         // 执行点击操作
-        click_in_rect(rect, backend, instant_move);
+        inject_for_last_capture(true, [&] {
+            MouseHandler::click_in_rect_with_backend(rect, backend, instant_move);
+        });
 
         return true;
     } else {
         return false;
     }
 }
+
+UIAutomator::ScreenContext::ScreenContext(int tile_size)
+    : ScreenContext(Matcher{
+        [](const cv::Mat& screen, const UILayouts::Metadata& layout, double confidence) {
+            return UIAutomator::verify(screen, layout, confidence);
+        },
+        [](const cv::Mat& screen, const cv::Rect& search, const UITemplates::Metadata& template_, double confidence) {
+            return UIAutomator::find(screen, template_, confidence, search);
+        },
+        [](const UITemplates::Metadata& template_) {
+            return load_template(template_).size();
+        },
+    }, tile_size) {}
+
+UIAutomator::PrewarmResult UIAutomator::prewarm(const PrewarmCallback& on_progress) {
+    PrewarmResult result;
+    result.total = UILayouts::ALL.size() + UITemplates::ALL.size();
+
+    auto report = [&](const char* name, bool ok) {
+        if (ok) {
+            ++result.loaded;
+        } else {
+            ++result.failed;
+        }
+        if (on_progress) {
+            on_progress(result.loaded + result.failed, result.total, name, ok);
+        }
+    };
+
+    for (const UILayouts::Metadata* layout : UILayouts::ALL) {
+        report(layout->name, !load_layout(*layout).empty());
+    }
+    for (const UITemplates::Metadata* template_ : UITemplates::ALL) {
+        report(template_->name, !load_template(*template_).empty());
+    }
+
+    // 特征检测器与匹配器的首次创建同样耗时，一并完成
+    PointMatcher::prewarm();
+    return result;
+}
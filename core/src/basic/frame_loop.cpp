@@ -0,0 +1,88 @@
+#include "basic/frame_loop.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+FrameLoop::Clock::duration period_for_rate(double rate_hz) {
+    if (rate_hz <= 0.0) {
+        return FrameLoop::Clock::duration::zero();
+    }
+    const double clamped = (std::max)(rate_hz, 1.0);
+    return std::chrono::duration_cast<FrameLoop::Clock::duration>(std::chrono::duration<double>(1.0 / clamped));
+}
+
+} // namespace
+
+FrameLoop::FrameLoop(StopToken& stop_token, const std::string& metrics_prefix)
+    : FrameLoop(stop_token, metrics_prefix, Options()) {}
+
+FrameLoop::FrameLoop(StopToken& stop_token, const std::string& metrics_prefix, Options options)
+    : stop_token_(stop_token),
+      options_(options),
+      period_(period_for_rate(options.target_hz)),
+      interval_latency_(Metrics::instance().histogram(metrics_prefix + ".interval")),
+      jitter_latency_(Metrics::instance().histogram(metrics_prefix + ".jitter")),
+      deadline_misses_(Metrics::instance().counter(metrics_prefix + ".deadline_misses")),
+      skipped_frames_(Metrics::instance().counter(metrics_prefix + ".skipped_frames")) {}
+
+bool FrameLoop::waitUntil(Clock::time_point deadline) {
+    const auto spin_from = deadline - options_.spin_margin;
+    if (Clock::now() < spin_from && !stop_token_.sleepUntil(spin_from)) {
+        return false;
+    }
+    while (Clock::now() < deadline) {
+        if (stop_token_.stopRequested()) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return !stop_token_.stopRequested();
+}
+
+void FrameLoop::run(const FrameCallback& on_frame) {
+    uint64_t index = 0;
+    Clock::time_point next = Clock::now();
+    Clock::time_point last_start{};
+
+    while (waitUntil(next)) {
+        const auto started = Clock::now();
+        const bool has_previous = (last_start != Clock::time_point{});
+        const Frame frame{index++, next, started, has_previous ? started - last_start : Clock::duration::zero()};
+        jitter_latency_.record(started - next);
+        if (has_previous) {
+            interval_latency_.record(started - last_start);
+        }
+        last_start = started;
+
+        const Action action = on_frame(frame);
+        if (action.kind() == Action::Kind::Stop) {
+            break;
+        }
+        if (action.kind() == Action::Kind::Backoff) {
+            if (!stop_token_.sleepFor(action.delay())) {
+                break;
+            }
+            next = Clock::now();
+            last_start = {};
+            continue;
+        }
+
+        const auto finished = Clock::now();
+        if (period_ == Clock::duration::zero()) {
+            next = finished;
+            continue;
+        }
+        const auto deadline = next + period_;
+        if (finished > deadline) {
+            deadline_misses_.add();
+        }
+        next = deadline;
+        if (finished > next + period_) {
+            const auto skipped = (finished - next) / period_;
+            skipped_frames_.add(static_cast<uint64_t>(skipped));
+            next += skipped * period_;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "basic/frame_trace.h"
+
+#include "basic/metrics.h"
+
+namespace {
+
+struct TraceMetrics {
+    std::array<LatencyHistogram*, FrameTrace::STAGE_COUNT> stages;
+    LatencyHistogram& total;
+    Metrics::Counter& untagged;
+};
+
+TraceMetrics& trace_metrics() {
+    static TraceMetrics metrics{
+        {
+            &Metrics::instance().histogram("e2e.capture"),
+            &Metrics::instance().histogram("e2e.convert"),
+            &Metrics::instance().histogram("e2e.detect"),
+            &Metrics::instance().histogram("e2e.decide"),
+            &Metrics::instance().histogram("e2e.inject"),
+        },
+        Metrics::instance().histogram("e2e.total"),
+        Metrics::instance().counter("e2e.untagged_inputs"),
+    };
+    return metrics;
+}
+
+} // namespace
+
+thread_local FrameTrace FrameTrace::last_captured_;
+
+void FrameTrace::record() const {
+    if (!valid()) {
+        return;
+    }
+    TraceMetrics& metrics = trace_metrics();
+    Clock::time_point previous = captured_at_;
+    for (int stage = CAPTURE; stage < STAGE_COUNT; ++stage) {
+        const Clock::time_point end = marks_[stage] == Clock::time_point{} ? previous : marks_[stage];
+        metrics.stages[stage]->record(end - previous);
+        previous = end;
+    }
+    metrics.total.record(previous - captured_at_);
+}
+
+FrameTrace FrameTrace::captured(Clock::time_point started_at) {
+    FrameTrace trace(next_frame_id_.fetch_add(1, std::memory_order_relaxed), started_at);
+    trace.mark(CAPTURE);
+    last_captured_ = trace;
+    return trace;
+}
+
+uint64_t FrameTrace::inputInjected() {
+    if (!current_ || !current_->valid()) {
+        trace_metrics().untagged.add();
+        return 0;
+    }
+    if (current_->marks_[INJECT] == Clock::time_point{}) {
+        current_->mark(INJECT);
+        current_->record();
+    }
+    return current_->frameId();
+}
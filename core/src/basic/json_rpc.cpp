@@ -1,53 +1,114 @@
 #include "basic/json_rpc.h"
-#include <iostream>
+#include "basic/rpc_writer.h"
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+// 当前通道编码。读取与发送使用同一设置
+std::atomic<RpcEncoding::Mode> channel_encoding{RpcEncoding::Mode::Text};
+
+} // namespace
 
 //=========================================================================
 // 请求/响应 方法实现
 //=========================================================================
 
-std::optional<json> JsonRpc::parseRequest(const std::string& line) {
-    json request;
+bool JsonRpc::readMessage(std::istream& in, std::string& message) {
+    const RpcEncoding::Mode mode = encoding();
+    if (mode == RpcEncoding::Mode::Text) {
+        return static_cast<bool>(std::getline(in, message));
+    }
+
+    char header[RpcEncoding::FRAME_HEADER_SIZE];
+    if (!in.read(header, sizeof(header))) {
+        return false;
+    }
+    const uint32_t size = RpcEncoding::read_frame_header(header);
+    if (size > RpcEncoding::MAX_FRAME_SIZE) {
+        // 长度前缀已经不可信，之后的字节流无法再对齐到帧边界
+        return false;
+    }
+    message.resize(size);
+    return size == 0 || static_cast<bool>(in.read(message.data(), size));
+}
+
+std::optional<json> JsonRpc::parseMessage(const std::string& line) {
+    const RpcEncoding::Mode mode = encoding();
+    json message;
     try {
-        request = json::parse(line);
+        message = RpcEncoding::decode(line, mode);
     } catch (...) {
-        // JSON 格式本身错误，无法解析
+        // 消息格式本身错误，无法解析
         json error_response;
         error_response["jsonrpc"] = "2.0";
         error_response["id"] = nullptr;
         error_response["error"]["code"] = -32700; // Parse error
-        error_response["error"]["message"] = "JSON 解析错误：" + line;
+        error_response["error"]["message"] = RpcEncoding::is_binary(mode)
+            ? std::string("消息解析错误：无效的 ") + RpcEncoding::to_string(mode) + " 负载。"
+            : "JSON 解析错误：" + line;
         send(error_response);
         return std::nullopt;
     }
 
-    // 验证是否是符合规范的请求
-    if (!request.is_object() || !request.contains("jsonrpc") || !request.contains("method") || !request.contains("id")) {
+    // 空的批量请求按规范只回复一个错误对象
+    if (message.is_array() && message.empty()) {
         json error_response;
         error_response["jsonrpc"] = "2.0";
-        if (request.is_object()) {
-            error_response["id"] = request.value("id", nullptr);
-        } else {
-            error_response["id"] = nullptr;
-        }
+        error_response["id"] = nullptr;
         error_response["error"]["code"] = -32600; // Invalid Request
-        error_response["error"]["message"] = "无效的 JSON-RPC 请求对象。";
+        error_response["error"]["message"] = "空的批量请求。";
         send(error_response);
         return std::nullopt;
     }
 
-    return request;
+    return message;
 }
 
-void JsonRpc::sendSuccessResponse(const json& request, const json& result) {
-    send(createResponse(request, result, std::nullopt));
+std::optional<json> JsonRpc::validateRequest(const json& request) {
+    if (request.is_object() && request.contains("jsonrpc") && request.contains("method") && request.contains("id")) {
+        return std::nullopt;
+    }
+
+    json error_response;
+    error_response["jsonrpc"] = "2.0";
+    if (request.is_object()) {
+        error_response["id"] = request.value("id", nullptr);
+    } else {
+        error_response["id"] = nullptr;
+    }
+    error_response["error"]["code"] = -32600; // Invalid Request
+    error_response["error"]["message"] = "无效的 JSON-RPC 请求对象。";
+    return error_response;
 }
 
-void JsonRpc::sendErrorResponse(const json& request, const std::string& error_message) {
+json JsonRpc::successResponse(const json& request, const json& result) {
+    return createResponse(request, result, std::nullopt);
+}
+
+json JsonRpc::errorResponse(const json& request, const std::string& error_message) {
     json error_obj;
     error_obj["code"] = -32000; // 使用一个通用的服务器错误码
     error_obj["message"] = error_message;
 
-    send(createResponse(request, std::nullopt, error_obj));
+    return createResponse(request, std::nullopt, error_obj);
+}
+
+void JsonRpc::sendResponse(const json& response) {
+    send(response);
+}
+
+void JsonRpc::sendSuccessResponse(const json& request, const json& result) {
+    send(successResponse(request, result));
+}
+
+void JsonRpc::sendErrorResponse(const json& request, const std::string& error_message) {
+    send(errorResponse(request, error_message));
 }
 
 
@@ -67,6 +128,14 @@ void JsonRpc::sendError(const std::string& method, const std::string& message, c
     sendMessage(method, MessageLevel::Error, message, payload);
 }
 
+void JsonRpc::sendNotification(const std::string& method, const json& params) {
+    send({
+        {"jsonrpc", "2.0"},
+        {"method", method},
+        {"params", params}
+    });
+}
+
 
 //=========================================================================
 // 私有辅助函数实现
@@ -127,10 +196,30 @@ json JsonRpc::createResponse(const json& request,
     return response;
 }
 
+void JsonRpc::flush() {
+    RpcWriter::instance().flush();
+}
+
+void JsonRpc::setEncoding(RpcEncoding::Mode mode) {
+    if (channel_encoding.exchange(mode) == mode) {
+        return;
+    }
+#ifdef _WIN32
+    // 二进制帧中可能出现 0x0D/0x1A 等字节，必须关闭 CRT 的文本模式转换
+    _setmode(_fileno(stdin), RpcEncoding::is_binary(mode) ? _O_BINARY : _O_TEXT);
+#endif
+    RpcWriter::instance().switchEncoding(mode);
+}
+
+RpcEncoding::Mode JsonRpc::encoding() {
+    return channel_encoding.load();
+}
+
 /**
- * @brief 将最终的 JSON 对象序列化为字符串并发送到标准输出。
- * 这是所有消息发送的最终出口。
+ * @brief 将最终的 JSON 对象按当前通道编码序列化并交给写线程。
+ * 这是所有消息发送的最终出口。序列化在调用线程完成，实际输出由 RpcWriter 批量执行。
  */
 void JsonRpc::send(const json& j) {
-    std::cout << j.dump() << std::endl;
+    const RpcEncoding::Mode mode = encoding();
+    RpcWriter::instance().enqueue(RpcEncoding::encode(j, mode), mode);
 }
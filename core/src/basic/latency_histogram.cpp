@@ -0,0 +1,111 @@
+#include "basic/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int most_significant_bit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    // 高于线性区时，按最高位确定指数，保留 SUB_BUCKET_BITS 位有效数字
+    const int exponent = most_significant_bit(value) - SUB_BUCKET_BITS + 1;
+    const uint64_t mantissa = value >> exponent;
+    return static_cast<size_t>(exponent * SUB_BUCKET_HALF + mantissa);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    const uint64_t exponent = index / SUB_BUCKET_HALF - 1;
+    const uint64_t mantissa = index - exponent * SUB_BUCKET_HALF;
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void LatencyHistogram::recordMicros(uint64_t micros) {
+    const uint64_t value = (std::min)(micros, MAX_VALUE);
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current_min = min_.load(std::memory_order_relaxed);
+    while (value < current_min && !min_.compare_exchange_weak(current_min, value, std::memory_order_relaxed)) {
+    }
+    uint64_t current_max = max_.load(std::memory_order_relaxed);
+    while (value > current_max && !max_.compare_exchange_weak(current_max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    const uint64_t total = count_.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+    const double clamped = (std::max)(0.0, (std::min)(100.0, percent));
+    const auto target = (std::max)(uint64_t{1}, static_cast<uint64_t>(std::ceil(total * clamped / 100.0)));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return (std::min)(bucketUpperBound(i), max_.load(std::memory_order_relaxed));
+        }
+    }
+    return max_.load(std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot result;
+    result.count = count_.load(std::memory_order_relaxed);
+    if (result.count == 0) {
+        return result;
+    }
+    result.min_us = min_.load(std::memory_order_relaxed);
+    result.max_us = max_.load(std::memory_order_relaxed);
+    result.mean_us = static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(result.count);
+    result.p50_us = percentile(50.0);
+    result.p95_us = percentile(95.0);
+    result.p99_us = percentile(99.0);
+    return result;
+}
+
+json LatencyHistogram::summary() const {
+    const Snapshot s = snapshot();
+    return {
+        {"count", s.count},
+        {"min_us", s.min_us},
+        {"mean_us", s.mean_us},
+        {"p50_us", s.p50_us},
+        {"p95_us", s.p95_us},
+        {"p99_us", s.p99_us},
+        {"max_us", s.max_us}
+    };
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
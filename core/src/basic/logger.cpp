@@ -1,34 +1,394 @@
 #include "basic/logger.h"
 
-Logger::Logger(std::function<void(const json&)> sender)
-    : sender_(std::move(sender)) {}
+#include <array>
+#include <chrono>
+#include <cstring>
 
-void Logger::info(const std::string& message) const {
-    if (sender_) {
-        sender_({
-            {"type", "log"},
-            {"level", "info"},
-            {"message", message}
-        });
+#include "basic/json_rpc.h"
+#include "basic/rpc_writer.h"
+
+namespace {
+
+// 单条日志正文的最大字节数，超出部分在 UTF-8 字符边界处截断
+constexpr size_t MESSAGE_CAPACITY = 1000;
+
+// 池中记录数，写线程每批写出后立即归还，正常情况下远用不完
+constexpr size_t POOL_SIZE = 512;
+
+// 取记录时最多探测的槽位数，突发写满时尽快退化为堆分配而不是扫描整个池
+constexpr size_t MAX_PROBES = 8;
+
+constexpr std::string_view TRUNCATED_SUFFIX = "...";
+
+// U+FFFD，替换正文中不合法的 UTF-8 字节
+constexpr std::string_view REPLACEMENT_CHARACTER = "\xEF\xBF\xBD";
+
+} // namespace
+
+/**
+ * @brief 定长日志记录，只在写线程上序列化为 log 通知。
+ *
+ * 正文要么在调用线程上复制进 message，要么以格式串加捕获参数的形式保存，由写线程渲染。
+ */
+struct LogRecord final : RpcWriter::OutboundMessage {
+    static constexpr size_t ARGS_CAPACITY = 192;
+
+    std::atomic<bool> in_use{false};
+    bool pooled = true;
+    bool truncated = false;
+    Logger::Level level = Logger::Level::Info;
+    uint16_t length = 0;
+    uint32_t suppressed = 0;
+
+    const char* format = nullptr;
+    void (*render)(std::string&, const char*, const void*) = nullptr;
+    void (*destroy)(void*) = nullptr;
+    alignas(std::max_align_t) unsigned char args[ARGS_CAPACITY];
+
+    char message[MESSAGE_CAPACITY];
+
+    void assign(Logger::Level record_level, std::string_view text) {
+        level = record_level;
+        suppressed = 0;
+        format = nullptr;
+        render = nullptr;
+        destroy = nullptr;
+        size_t size = text.size();
+        truncated = size > MESSAGE_CAPACITY;
+        if (truncated) {
+            size = MESSAGE_CAPACITY;
+            // 回退到 UTF-8 字符的起始字节，避免截断出非法序列
+            while (size > 0 && (static_cast<unsigned char>(text[size]) & 0xC0) == 0x80) {
+                --size;
+            }
+        }
+        std::memcpy(message, text.data(), size);
+        length = static_cast<uint16_t>(size);
     }
+
+    void appendTo(std::string& batch, RpcEncoding::Mode channel_encoding) override;
+    void release() override;
+};
+
+namespace {
+
+std::array<LogRecord, POOL_SIZE> record_pool;
+std::atomic<size_t> pool_cursor{0};
+std::atomic<uint64_t> pool_fallbacks{0};
+
+LogRecord* acquireRecord() {
+    // 记录按入队顺序归还，从游标处开始找通常第一次就能命中
+    const size_t start = pool_cursor.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < MAX_PROBES; ++i) {
+        LogRecord& record = record_pool[(start + i) % POOL_SIZE];
+        bool expected = false;
+        if (!record.in_use.load(std::memory_order_relaxed) &&
+            record.in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return &record;
+        }
+    }
+    pool_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    auto* record = new LogRecord();
+    record->pooled = false;
+    return record;
 }
 
-void Logger::warn(const std::string& message) const {
-    if (sender_) {
-        sender_({
-            {"type", "log"},
-            {"level", "warn"},
-            {"message", message}
-        });
+} // namespace
+
+void LogRecord::release() {
+    if (destroy) {
+        destroy(args);
+        destroy = nullptr;
+    }
+    if (pooled) {
+        in_use.store(false, std::memory_order_release);
+    } else {
+        delete this;
     }
 }
 
-void Logger::error(const std::string& message) const {
-    if (sender_) {
-        sender_({
-            {"type", "log"},
-            {"level", "error"},
-            {"message", message}
-        });
+namespace {
+
+// 从 pos 开始的合法 UTF-8 序列的字节数，不合法时返回 0。
+// 与 nlohmann::json 的校验一致：拒绝超长编码、代理区码位与大于 U+10FFFF 的码位
+size_t utf8SequenceLength(std::string_view text, size_t pos) {
+    const auto byte = [&](size_t i) { return static_cast<unsigned char>(text[i]); };
+    const unsigned char lead = byte(pos);
+    if (lead < 0x80) {
+        return 1;
+    }
+    size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+    if (pos + length > text.size() || byte(pos + 1) < low || byte(pos + 1) > high) {
+        return 0;
+    }
+    for (size_t i = 2; i < length; ++i) {
+        if ((byte(pos + i) & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+// 把不合法的 UTF-8 字节逐个替换为 U+FFFD，文本与二进制编码的输出因此一致且总是合法
+void sanitizeUtf8(std::string& text) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const size_t length = utf8SequenceLength(text, pos);
+        if (length == 0) {
+            break;
+        }
+        pos += length;
+    }
+    if (pos == text.size()) {
+        return;
+    }
+
+    std::string sanitized(text, 0, pos);
+    while (pos < text.size()) {
+        const size_t length = utf8SequenceLength(text, pos);
+        if (length == 0) {
+            sanitized.append(REPLACEMENT_CHARACTER);
+            ++pos;
+        } else {
+            sanitized.append(text, pos, length);
+            pos += length;
+        }
+    }
+    text.swap(sanitized);
+}
+
+void appendJsonString(std::string& out, std::string_view text) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    out.push_back('"');
+    for (const char c : text) {
+        switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            case '\b': out.append("\\b"); break;
+            case '\f': out.append("\\f"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out.append("\\u00");
+                    out.push_back(HEX[(c >> 4) & 0x0F]);
+                    out.push_back(HEX[c & 0x0F]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+int64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void LogRecord::appendTo(std::string& batch, RpcEncoding::Mode channel_encoding) {
+    // 写线程专用的渲染缓冲，容量在多次调用间复用
+    static thread_local std::string rendered;
+    rendered.clear();
+    if (render) {
+        render(rendered, format, args);
+    } else {
+        rendered.append(message, length);
+        if (truncated) {
+            rendered.append(TRUNCATED_SUFFIX);
+        }
+    }
+    Logger::appendSuppressed(rendered, suppressed);
+    sanitizeUtf8(rendered);
+
+    const std::string_view full = rendered;
+    const char* level_name = Logger::levelToString(level);
+
+    if (channel_encoding == RpcEncoding::Mode::Text) {
+        // 与 JsonRpc::sendMessage 生成的 log 通知结构一致，直接拼接避免构造 json 对象
+        for (int pass = 0; pass < 2; ++pass) {
+            batch.append(pass == 0
+                ? R"({"jsonrpc":"2.0","method":"log","params":{"level":")"
+                : R"(,"payload":{"type":"log","level":")");
+            batch.append(level_name);
+            batch.append(R"(","message":)");
+            appendJsonString(batch, full);
+        }
+        batch.append("}}}\n");
+        return;
+    }
+
+    try {
+        const json notification = {
+            {"jsonrpc", "2.0"},
+            {"method", "log"},
+            {"params", {
+                {"level", level_name},
+                {"message", full},
+                {"payload", {{"type", "log"}, {"level", level_name}, {"message", full}}}
+            }}
+        };
+        batch.append(RpcEncoding::encode(notification, channel_encoding));
+    } catch (const json::exception&) {
+        // 正文已替换为合法的 UTF-8，编码失败时丢弃这一条
+    }
+}
+
+void Logger::setMinLevel(Level level) {
+    min_level_.store(level, std::memory_order_relaxed);
+}
+
+Logger::Level Logger::minLevel() {
+    return min_level_.load(std::memory_order_relaxed);
+}
+
+const char* Logger::levelToString(Level level) {
+    switch (level) {
+        case Level::Debug: return "debug";
+        case Level::Info:  return "info";
+        case Level::Warn:  return "warn";
+        case Level::Error: return "error";
+        case Level::Off:   return "off";
+    }
+    return "info";
+}
+
+std::optional<Logger::Level> Logger::levelFromString(std::string_view name) {
+    for (const Level level : {Level::Debug, Level::Info, Level::Warn, Level::Error, Level::Off}) {
+        if (name == levelToString(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+void Logger::setCategoryMask(uint32_t mask) {
+    category_mask_.store(mask & ALL_CATEGORIES, std::memory_order_relaxed);
+}
+
+uint32_t Logger::categoryMask() {
+    return category_mask_.load(std::memory_order_relaxed);
+}
+
+const char* Logger::categoryToString(Category category) {
+    switch (category) {
+        case Category::General:  return "general";
+        case Category::Workflow: return "workflow";
+        case Category::Capture:  return "capture";
+        case Category::Vision:   return "vision";
+        case Category::Input:    return "input";
+    }
+    return "general";
+}
+
+std::optional<Logger::Category> Logger::categoryFromString(std::string_view name) {
+    for (const Category category : {Category::General, Category::Workflow, Category::Capture,
+                                    Category::Vision, Category::Input}) {
+        if (name == categoryToString(category)) {
+            return category;
+        }
+    }
+    return std::nullopt;
+}
+
+json Logger::poolStats() {
+    return {
+        {"capacity", POOL_SIZE},
+        {"message_capacity", MESSAGE_CAPACITY},
+        {"heap_fallbacks", pool_fallbacks.load(std::memory_order_relaxed)}
+    };
+}
+
+void Logger::log(Level level, std::string_view message) const {
+    if (level == Level::Off || !isEnabled(level)) {
+        return;
+    }
+    LogRecord* record = acquireRecord();
+    record->assign(level, message);
+    RpcWriter::instance().enqueue(record);
+}
+
+LogRecord* Logger::acquireDeferred(Level level, uint32_t suppressed, const char* format,
+                                   RenderFn render, DestroyFn destroy, void** storage) {
+    static_assert(DEFERRED_ARGS_CAPACITY == LogRecord::ARGS_CAPACITY, "参数区容量不一致");
+    LogRecord* record = acquireRecord();
+    record->level = level;
+    record->suppressed = suppressed;
+    record->truncated = false;
+    record->length = 0;
+    record->format = format;
+    record->render = render;
+    record->destroy = destroy;
+    *storage = record->args;
+    return record;
+}
+
+void Logger::submitDeferred(LogRecord* record) {
+    RpcWriter::instance().enqueue(record);
+}
+
+void Logger::appendSuppressed(std::string& text, uint32_t suppressed) {
+    if (suppressed == 0) {
+        return;
+    }
+    text.append("（此前已抑制 ");
+    LogFormat::appendArg(text, suppressed);
+    text.append(" 条）");
+}
+
+void Logger::debug(std::string_view message) const {
+    log(Level::Debug, message);
+}
+
+void Logger::info(std::string_view message) const {
+    log(Level::Info, message);
+}
+
+void Logger::warn(std::string_view message) const {
+    log(Level::Warn, message);
+}
+
+void Logger::error(std::string_view message) const {
+    log(Level::Error, message);
+}
+
+void Logger::notify(const std::string& type, const json& payload) const {
+    json package = payload;
+    package["type"] = type;
+    package["level"] = "info";
+    package["message"] = "";
+    JsonRpc::sendInfo(type, "", package);
+}
+
+LogRateLimiter::LogRateLimiter(uint32_t interval_ms)
+    : interval_us_(static_cast<int64_t>(interval_ms) * 1000) {}
+
+bool LogRateLimiter::allow(uint32_t& suppressed) {
+    const int64_t now = steady_now_us();
+    int64_t next_allowed = next_allowed_us_.load(std::memory_order_relaxed);
+    if (now >= next_allowed &&
+        next_allowed_us_.compare_exchange_strong(next_allowed, now + interval_us_, std::memory_order_relaxed)) {
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
     }
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
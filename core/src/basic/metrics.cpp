@@ -0,0 +1,126 @@
+#include "basic/metrics.h"
+
+#include <algorithm>
+
+#include "basic/json_rpc.h"
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Metrics() : created_at_(std::chrono::steady_clock::now()) {}
+
+Metrics::Counter& Metrics::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = counters_[name];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+Metrics::Gauge& Metrics::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = gauges_[name];
+    if (!slot) {
+        slot = std::make_unique<Gauge>();
+    }
+    return *slot;
+}
+
+LatencyHistogram& Metrics::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) {
+        slot = std::make_unique<LatencyHistogram>();
+    }
+    return *slot;
+}
+
+json Metrics::snapshot() const {
+    json counters = json::object();
+    json gauges = json::object();
+    json histograms = json::object();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, counter] : counters_) {
+            counters[name] = counter->value();
+        }
+        for (const auto& [name, gauge] : gauges_) {
+            gauges[name] = gauge->value();
+        }
+        for (const auto& [name, histogram] : histograms_) {
+            histograms[name] = histogram->summary();
+        }
+    }
+    const auto uptime = std::chrono::steady_clock::now() - created_at_;
+    return {
+        {"uptime_ms", std::chrono::duration_cast<std::chrono::milliseconds>(uptime).count()},
+        {"counters", std::move(counters)},
+        {"gauges", std::move(gauges)},
+        {"histograms", std::move(histograms)}
+    };
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [name, counter] : counters_) {
+        counter->reset();
+    }
+    for (auto& [name, histogram] : histograms_) {
+        histogram->reset();
+    }
+}
+
+MetricsStreamer::~MetricsStreamer() {
+    stop();
+}
+
+std::chrono::milliseconds MetricsStreamer::start(std::chrono::milliseconds interval) {
+    const auto applied = (std::max)(interval, MIN_INTERVAL);
+    std::lock_guard<std::mutex> control(control_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interval_ = applied;
+        if (running_) {
+            cv_.notify_one();
+            return applied;
+        }
+        running_ = true;
+    }
+    thread_ = std::thread(&MetricsStreamer::streamLoop, this);
+    return applied;
+}
+
+void MetricsStreamer::stop() {
+    std::lock_guard<std::mutex> control(control_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void MetricsStreamer::streamLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto last_send = std::chrono::steady_clock::now();
+    while (running_) {
+        // 间隔被修改时提前醒来，按新间隔从上一次推送重新计算截止时间
+        const auto interval = interval_;
+        if (cv_.wait_until(lock, last_send + interval, [&] { return !running_ || interval_ != interval; })) {
+            continue;
+        }
+        last_send = std::chrono::steady_clock::now();
+        const auto interval_ms = interval_.count();
+
+        lock.unlock();
+        json params = Metrics::instance().snapshot();
+        params["interval_ms"] = interval_ms;
+        JsonRpc::sendNotification("metrics/snapshot", params);
+        lock.lock();
+    }
+}
@@ -0,0 +1,97 @@
+#include "basic/resource_scheduler.h"
+
+namespace {
+
+struct ResourceInfo {
+    TaskResource resource;
+    const char* key;
+    const char* label;
+};
+
+constexpr ResourceInfo RESOURCE_INFO[] = {
+    {RESOURCE_INPUT, "input", "输入"},
+    {RESOURCE_FOREGROUND, "foreground", "前台窗口"},
+    {RESOURCE_CAPTURE, "capture", "截图"},
+};
+
+} // namespace
+
+bool ResourceScheduler::tryAcquire(const std::string& owner, uint32_t resources, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string holder = findConflictLocked(resources, owner);
+    if (!holder.empty()) {
+        const uint32_t conflicting = holdings_.at(holder) & resources & EXCLUSIVE_RESOURCES;
+        error = "资源「" + describe(conflicting) + "」正被任务 '" + holder + "' 占用。";
+        return false;
+    }
+    holdings_[owner] = resources;
+    return true;
+}
+
+void ResourceScheduler::release(const std::string& owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    holdings_.erase(owner);
+}
+
+std::string ResourceScheduler::findConflict(uint32_t resources, const std::string& owner) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return findConflictLocked(resources, owner);
+}
+
+std::string ResourceScheduler::findConflictLocked(uint32_t resources, const std::string& owner) const {
+    const uint32_t exclusive = resources & EXCLUSIVE_RESOURCES;
+    if (exclusive == 0) {
+        return {};
+    }
+    for (const auto& [holder, held] : holdings_) {
+        if (holder != owner && (held & exclusive) != 0) {
+            return holder;
+        }
+    }
+    return {};
+}
+
+json ResourceScheduler::snapshot() const {
+    json result = json::object();
+    for (const auto& info : RESOURCE_INFO) {
+        result[info.key] = (info.resource & EXCLUSIVE_RESOURCES) ? json(nullptr) : json::array();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [holder, held] : holdings_) {
+        for (const auto& info : RESOURCE_INFO) {
+            if ((held & info.resource) == 0) {
+                continue;
+            }
+            if (info.resource & EXCLUSIVE_RESOURCES) {
+                result[info.key] = holder;
+            } else {
+                result[info.key].push_back(holder);
+            }
+        }
+    }
+    return result;
+}
+
+json ResourceScheduler::toJson(uint32_t resources) {
+    json result = json::array();
+    for (const auto& info : RESOURCE_INFO) {
+        if (resources & info.resource) {
+            result.push_back(info.key);
+        }
+    }
+    return result;
+}
+
+std::string ResourceScheduler::describe(uint32_t resources) {
+    std::string result;
+    for (const auto& info : RESOURCE_INFO) {
+        if (resources & info.resource) {
+            if (!result.empty()) {
+                result += "、";
+            }
+            result += info.label;
+        }
+    }
+    return result.empty() ? "无" : result;
+}
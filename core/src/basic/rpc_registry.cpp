@@ -0,0 +1,83 @@
+#include "basic/rpc_registry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "basic/exceptions.h"
+#include "basic/json_rpc.h"
+
+void RpcRegistry::registerMethod(std::string name, Handler handler, bool fast_lane) {
+    const uint64_t key = hashMethod(name);
+    const auto existing = methods_.find(key);
+    if (existing != methods_.end()) {
+        throw std::logic_error("RPC 方法 '" + name + "' 与已注册的 '" + existing->second->name + "' 冲突。");
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->name = std::move(name);
+    entry->handler = std::move(handler);
+    entry->fast_lane = fast_lane;
+    methods_.emplace(key, std::move(entry));
+}
+
+const RpcRegistry::Entry* RpcRegistry::find(std::string_view method) const {
+    const auto it = methods_.find(hashMethod(method));
+    if (it == methods_.end() || it->second->name != method) {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+bool RpcRegistry::isFastLane(std::string_view method) const {
+    const Entry* entry = find(method);
+    return entry && entry->fast_lane;
+}
+
+json RpcRegistry::call(const json& request) const {
+    const std::string method = request.value("method", "");
+    const Entry* entry = find(method);
+    if (!entry) {
+        return JsonRpc::errorResponse(request, "未知方法: '" + method + "'。");
+    }
+
+    const json params = request.value("params", json::object());
+    const auto started_at = std::chrono::steady_clock::now();
+    json response;
+    try {
+        response = JsonRpc::successResponse(request, entry->handler(params));
+    } catch (const RpcException& e) {
+        entry->errors.fetch_add(1, std::memory_order_relaxed);
+        response = JsonRpc::errorResponse(request, e.what());
+    } catch (const std::exception& e) {
+        entry->errors.fetch_add(1, std::memory_order_relaxed);
+        response = JsonRpc::errorResponse(request, std::string("处理请求时发生异常: ") + e.what());
+    }
+    entry->latency.record(std::chrono::steady_clock::now() - started_at);
+    entry->calls.fetch_add(1, std::memory_order_relaxed);
+    return response;
+}
+
+json RpcRegistry::stats() const {
+    std::vector<const Entry*> entries;
+    entries.reserve(methods_.size());
+    for (const auto& [key, entry] : methods_) {
+        entries.push_back(entry.get());
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->name < b->name;
+    });
+
+    json methods = json::array();
+    for (const Entry* entry : entries) {
+        methods.push_back({
+            {"method", entry->name},
+            {"fast_lane", entry->fast_lane},
+            {"calls", entry->calls.load(std::memory_order_relaxed)},
+            {"errors", entry->errors.load(std::memory_order_relaxed)},
+            {"latency", entry->latency.summary()}
+        });
+    }
+    return {{"methods", methods}};
+}
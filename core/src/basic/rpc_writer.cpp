@@ -0,0 +1,172 @@
+#include "basic/rpc_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+// 单批次输出缓冲的初始容量，足以容纳一般情况下一次取空的所有消息
+constexpr size_t INITIAL_BATCH_CAPACITY = 64 * 1024;
+
+// 写线程休眠的兜底超时，防止极端情况下错过唤醒
+constexpr auto WRITER_IDLE_TIMEOUT = std::chrono::milliseconds(100);
+
+} // namespace
+
+// 已按某种编码序列化好的消息，与通道编码不一致时在写线程中转码
+struct RpcWriter::EncodedMessage : OutboundMessage {
+    std::string bytes;
+    RpcEncoding::Mode encoding = RpcEncoding::Mode::Text;
+
+    void appendTo(std::string& batch, RpcEncoding::Mode channel_encoding) override {
+        if (encoding == channel_encoding) {
+            batch.append(bytes);
+            return;
+        }
+        try {
+            const json j = RpcEncoding::decode_message(bytes, encoding);
+            batch.append(RpcEncoding::encode(j, channel_encoding));
+        } catch (const json::exception&) {
+            // 消息本身已损坏，丢弃
+        }
+    }
+};
+
+struct RpcWriter::EncodingSwitch : OutboundMessage {
+    RpcEncoding::Mode encoding = RpcEncoding::Mode::Text;
+
+    void appendTo(std::string&, RpcEncoding::Mode) override {}
+
+    bool switchesEncoding(RpcEncoding::Mode& target) const override {
+        target = encoding;
+        return true;
+    }
+};
+
+RpcWriter& RpcWriter::instance() {
+    static RpcWriter writer(std::cout);
+    return writer;
+}
+
+RpcWriter::RpcWriter(std::ostream& out) : out_(out) {
+    writer_thread_ = std::thread(&RpcWriter::writerLoop, this);
+}
+
+RpcWriter::~RpcWriter() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_one();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+}
+
+void RpcWriter::enqueue(std::string bytes, RpcEncoding::Mode encoding) {
+    auto* message = new EncodedMessage();
+    message->bytes = std::move(bytes);
+    message->encoding = encoding;
+    enqueue(message);
+}
+
+void RpcWriter::switchEncoding(RpcEncoding::Mode encoding) {
+    auto* message = new EncodingSwitch();
+    message->encoding = encoding;
+    enqueue(message);
+}
+
+void RpcWriter::enqueue(OutboundMessage* message) {
+    enqueued_count_.fetch_add(1);
+    queue_.push(message);
+
+    // 只有写线程声明自己即将休眠时才需要加锁唤醒，常规路径完全无锁
+    if (writer_sleeping_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void RpcWriter::flush() {
+    const uint64_t target = enqueued_count_.load();
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    writer_sleeping_ = false;
+    wake_cv_.notify_one();
+    flushed_cv_.wait(lock, [&] { return written_count_.load() >= target; });
+}
+
+size_t RpcWriter::drainInto(std::string& batch) {
+    size_t count = 0;
+    while (MpscNode* node = queue_.pop()) {
+        auto* message = static_cast<OutboundMessage*>(node);
+        RpcEncoding::Mode target;
+        if (message->switchesEncoding(target)) {
+            // 切换点之前的内容必须以旧的流模式写出
+            writeBatch(batch);
+            applyChannelEncoding(target);
+        } else {
+            message->appendTo(batch, channel_encoding_);
+        }
+        message->release();
+        ++count;
+    }
+    return count;
+}
+
+void RpcWriter::writeBatch(std::string& batch) {
+    if (batch.empty()) {
+        return;
+    }
+    out_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    out_.flush();
+    batch.clear();
+}
+
+void RpcWriter::applyChannelEncoding(RpcEncoding::Mode encoding) {
+    channel_encoding_ = encoding;
+#ifdef _WIN32
+    // 文本模式下 CRT 会把 '\n' 转换为 "\r\n"，二进制帧必须关闭该转换
+    if (&out_ == &std::cout) {
+        std::fflush(stdout);
+        _setmode(_fileno(stdout), RpcEncoding::is_binary(encoding) ? _O_BINARY : _O_TEXT);
+    }
+#endif
+}
+
+void RpcWriter::writerLoop() {
+    std::string batch;
+    batch.reserve(INITIAL_BATCH_CAPACITY);
+
+    while (true) {
+        batch.clear();
+        const size_t count = drainInto(batch);
+        if (count > 0) {
+            writeBatch(batch);
+            written_count_.fetch_add(count);
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            flushed_cv_.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        if (stopping_.load() && queue_.empty() && written_count_.load() >= enqueued_count_.load()) {
+            break;
+        }
+
+        writer_sleeping_ = true;
+        if (!queue_.empty()) {
+            writer_sleeping_ = false;
+            continue;
+        }
+        wake_cv_.wait_for(lock, WRITER_IDLE_TIMEOUT, [this] {
+            return !writer_sleeping_.load() || stopping_.load();
+        });
+        writer_sleeping_ = false;
+    }
+}
@@ -1,95 +1,272 @@
 #include "basic/service_app.h"
 #include "basic/json_rpc.h"
+#include "basic/exceptions.h"
+#include "basic/logger.h"
+#include "basic/base_config.h"
+#include "io/frame_ring.h"
+#include "io/frame_source.h"
+#include "io/screenshot.h"
 #include <iostream>
 
 /**
  * ServiceApp 构造函数
- * 将 TaskManager 的异步回调与 JsonRpc 的通知系统连接
+ * 任务日志由 Logger 直接写入 RpcWriter，这里只需注册各子系统的 RPC 方法
  */
-ServiceApp::ServiceApp()
-    : task_manager_([this](const json& package) {
-        std::string type = package.value("type", "log");
-        std::string level = package.value("level", "info");
-        std::string message = package.value("message", "");
-
-        if (level == "info") {
-            JsonRpc::sendInfo(type, message, package);
-        } else if (level == "warn") {
-            JsonRpc::sendWarn(type, message, package);
-        } else if (level == "error") {
-            JsonRpc::sendError(type, message, package);
+ServiceApp::ServiceApp() {
+    // 在启动时创建指标注册表，使 uptime_ms 从服务启动开始计算
+    Metrics::instance();
+    task_manager_.registerRpcMethods(rpc_registry_);
+    registerAppMethods();
+}
+
+namespace {
+
+json enabledCategories() {
+    json names = json::array();
+    for (const auto category : {Logger::Category::General, Logger::Category::Workflow, Logger::Category::Capture,
+                                Logger::Category::Vision, Logger::Category::Input}) {
+        if (Logger::categoryMask() & static_cast<uint32_t>(category)) {
+            names.push_back(Logger::categoryToString(category));
+        }
+    }
+    return names;
+}
+
+} // namespace
+
+void ServiceApp::registerAppMethods() {
+    rpc_registry_.registerMethod("app/shutdown", [this](const json&) -> json {
+        shutdown_requested_ = true;
+        return {{"message", "后端服务收到关闭请求，即将关闭。"}};
+    }, true);
+
+    rpc_registry_.registerMethod("app/rpcStats", [this](const json&) {
+        return rpc_registry_.stats();
+    }, true);
+
+    rpc_registry_.registerMethod("app/setLogLevel", [](const json& params) -> json {
+        const std::string name = params.value("level", "");
+        const auto level = Logger::levelFromString(name);
+        if (!level) {
+            throw RpcException("未知的日志级别: '" + name + "'，可选 debug/info/warn/error/off。");
+        }
+
+        // categories 可选：省略时保持不变，null 表示启用全部分类
+        std::optional<uint32_t> category_mask;
+        if (params.contains("categories")) {
+            const json& categories = params["categories"];
+            if (categories.is_null()) {
+                category_mask = Logger::ALL_CATEGORIES;
+            } else if (categories.is_array()) {
+                uint32_t mask = 0;
+                for (const auto& item : categories) {
+                    const auto category = item.is_string() ? Logger::categoryFromString(item.get<std::string>()) : std::nullopt;
+                    if (!category) {
+                        throw RpcException("未知的日志分类: " + item.dump());
+                    }
+                    mask |= static_cast<uint32_t>(*category);
+                }
+                category_mask = mask;
+            } else {
+                throw RpcException("'categories' 必须是字符串数组或 null。");
+            }
+        }
+
+        const Logger::Level previous = Logger::minLevel();
+        Logger::setMinLevel(*level);
+        if (category_mask) {
+            Logger::setCategoryMask(*category_mask);
+        }
+        return {
+            {"level", Logger::levelToString(*level)},
+            {"previous", Logger::levelToString(previous)},
+            {"categories", enabledCategories()}
+        };
+    }, true);
+
+    rpc_registry_.registerMethod("app/metrics", [](const json& params) -> json {
+        json snapshot = Metrics::instance().snapshot();
+        if (params.value("reset", false)) {
+            Metrics::instance().reset();
+        }
+        return snapshot;
+    }, true);
+
+    // interval_ms 为 0 时停止推送 metrics/snapshot 通知
+    rpc_registry_.registerMethod("app/streamMetrics", [this](const json& params) -> json {
+        const int64_t interval_ms = params.value("interval_ms", int64_t{0});
+        if (interval_ms <= 0) {
+            metrics_streamer_.stop();
+            return {{"interval_ms", 0}};
+        }
+        const auto applied = metrics_streamer_.start(std::chrono::milliseconds(interval_ms));
+        return {{"interval_ms", applied.count()}};
+    }, true);
+
+    // 立即返回，进度通过 prewarm/progress 通知汇报；已在预热时只返回当前进度
+    rpc_registry_.registerMethod("app/prewarm", [this](const json&) -> json {
+        const bool started = asset_prewarmer_.start();
+        json status = asset_prewarmer_.status();
+        status["started"] = started;
+        return status;
+    }, true);
+
+    // GUI 开始或停止读取预览共享内存；没有订阅者时任务不发布预览帧
+    rpc_registry_.registerMethod("app/subscribePreview", [](const json& params) -> json {
+        const bool enabled = params.value("enabled", true);
+        FramePreview::setSubscribed(enabled);
+        return {{"enabled", enabled}, {"ring", FramePreview::RING_NAME}};
+    }, true);
+
+    // 参数为 FrameSource::open 的描述；省略 type 或 type 为 "live" 时恢复实时截图
+    rpc_registry_.registerMethod("app/setFrameSource", [](const json& params) -> json {
+        const std::string type = params.is_object() ? params.value("type", "live") : "live";
+        if (type == "live") {
+            Screenshot::set_frame_source(nullptr);
+            return {{"source", "live"}, {"message", "已恢复实时截图。"}};
+        }
+        std::shared_ptr<IFrameSource> source;
+        try {
+            source = FrameSource::open(params);
+        } catch (const FrameSourceException& e) {
+            throw RpcException(e.what());
+        }
+        Screenshot::set_frame_source(source);
+        return {{"source", type}, {"message", "截图来源已切换为" + source->describe() + "。"}};
+    });
+
+    rpc_registry_.registerMethod("app/logStats", [](const json&) -> json {
+        json stats = Logger::poolStats();
+        stats["level"] = Logger::levelToString(Logger::minLevel());
+        stats["categories"] = enabledCategories();
+        return stats;
+    }, true);
+}
+
+ServiceApp::~ServiceApp() {
+    request_queue_.close();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
         }
-    })
-{}
+    }
+}
 
 /**
  * 应用主循环
- * 负责从 stdin 读取输入，并将其分派给请求处理器。
+ * 调用线程专职读取 stdin：快速通道的方法就地处理，其余请求交给工作线程池，
+ * 因此慢请求不会阻塞后续的状态查询。
  */
 void ServiceApp::run() {
+    for (size_t i = 0; i < WORKER_COUNT; ++i) {
+        workers_.emplace_back(&ServiceApp::workerLoop, this);
+    }
+
+    if (BaseConfig::PREWARM_ON_STARTUP) {
+        asset_prewarmer_.start();
+    }
+
     std::string line;
     while (!shutdown_requested_.load()) {
-        if (std::getline(std::cin, line)) {
-            if (auto opt_request = JsonRpc::parseRequest(line)) {
-                // 如果 opt_request 有值，说明它是一个完全有效的请求，可以直接处理
-                processCommand(*opt_request);
+        if (JsonRpc::readMessage(std::cin, line)) {
+            if (auto opt_message = JsonRpc::parseMessage(line)) {
+                // 如果 opt_message 有值，说明它是单个请求或批量请求，逐个校验后分派
+                dispatchMessage(std::move(*opt_message));
             }
-            // 如果没有值，说明输入有误，parseRequest已经自动发送了错误响应，这里什么都不用做
+            // 如果没有值，说明输入有误，parseMessage已经自动发送了错误响应，这里什么都不用做
         } else {
-            // 如果输入流结束或出错，则准备关闭应用
-            if (std::cin.eof() || std::cin.bad() || std::cin.fail()){
-                shutdown_requested_ = true;
-            }
+            // 如果输入流结束、出错或二进制帧已无法对齐，则准备关闭应用
+            shutdown_requested_ = true;
         }
     }
-}
 
-/**
- * 请求命令处理器
- * 负责解析有效的JSON-RPC请求并执行相应的操作。
- */
-void ServiceApp::processCommand(const json& j_request) {
-    const std::string method = j_request.value("method", "");
-    const json& params = j_request.value("params", json::object());
-
-    if (method == "task/start") {
-        const std::string task_name = params.value("task_name", "");
-        if (task_name.empty()) {
-            JsonRpc::sendErrorResponse(j_request, "启动任务命令缺少 'task_name' 参数。");
-            return;
-        }
+    // 已入队的请求仍会被处理完毕，每个请求都保证得到一个响应
+    request_queue_.close();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    JsonRpc::flush();
+}
 
-        if (task_manager_.startTask(task_name, params)) {
-            JsonRpc::sendSuccessResponse(j_request, {{"message", "任务 '" + task_name + "' 已成功请求启动。"}});
+void ServiceApp::dispatchMessage(json message) {
+    if (!message.is_array()) {
+        if (auto error_response = JsonRpc::validateRequest(message)) {
+            JsonRpc::sendResponse(*error_response);
+        } else if (message.value("method", "") == "app/setEncoding") {
+            handleSetEncoding(message);
         } else {
-            const std::string error_message = task_manager_.getLastError();
-            if (error_message.empty()) {
-                JsonRpc::sendErrorResponse(j_request, "启动任务 '" + task_name + "' 失败 (可能已有任务在运行)。");
-            } else {
-                JsonRpc::sendErrorResponse(j_request, error_message);
-            }
+            dispatchRequest({std::move(message), nullptr, 0});
         }
+        return;
+    }
 
-    } else if (method == "task/stop") {
-        if (task_manager_.stopCurrentTask()) {
-            JsonRpc::sendSuccessResponse(j_request, {{"message", "已发送停止当前任务的请求。"}});
+    // 批量请求：各子请求可并行执行，响应按原顺序汇总为一个数组，只写出一次
+    auto batch = std::make_shared<BatchContext>();
+    batch->responses.resize(message.size());
+    batch->remaining = message.size();
+
+    for (size_t i = 0; i < message.size(); ++i) {
+        PendingRequest pending{std::move(message[i]), batch, i};
+        if (auto error_response = JsonRpc::validateRequest(pending.request)) {
+            completeRequest(pending, std::move(*error_response));
+        } else if (pending.request.value("method", "") == "app/setEncoding") {
+            completeRequest(pending, JsonRpc::errorResponse(pending.request, "app/setEncoding 不能在批量请求中使用。"));
         } else {
-            JsonRpc::sendErrorResponse(j_request, "停止请求失败或当前无活动任务。");
+            dispatchRequest(std::move(pending));
         }
+    }
+}
+
+void ServiceApp::dispatchRequest(PendingRequest pending) {
+    const std::string method = pending.request.value("method", "");
+    if (rpc_registry_.isFastLane(method)) {
+        executeRequest(pending);
+        return;
+    }
 
-    } else if (method == "app/getStatus") {
-        json manager_status_report = task_manager_.getStatus();
-        JsonRpc::sendSuccessResponse(j_request, manager_status_report);
+    if (!request_queue_.tryPush(std::move(pending))) {
+        completeRequest(pending, JsonRpc::errorResponse(pending.request, "服务繁忙：待处理请求过多，请稍后重试。"));
+    }
+}
 
-    } else if (method == "app/getTasks") {
-        json task_list = task_manager_.getTaskList();
-        JsonRpc::sendSuccessResponse(j_request, task_list);
+void ServiceApp::executeRequest(const PendingRequest& pending) {
+    json response;
+    try {
+        response = rpc_registry_.call(pending.request);
+    } catch (const std::exception& e) {
+        response = JsonRpc::errorResponse(pending.request, std::string("处理请求时发生异常: ") + e.what());
+    }
+    completeRequest(pending, std::move(response));
+}
 
-    } else if (method == "app/shutdown") {
-        JsonRpc::sendSuccessResponse(j_request, {{"message", "后端服务收到关闭请求，即将关闭。"}});
-        shutdown_requested_ = true;
+void ServiceApp::completeRequest(const PendingRequest& pending, json response) {
+    if (!pending.batch) {
+        JsonRpc::sendResponse(response);
+        return;
+    }
+
+    pending.batch->responses[pending.index] = std::move(response);
+    if (pending.batch->remaining.fetch_sub(1) == 1) {
+        JsonRpc::sendResponse(json(std::move(pending.batch->responses)));
+    }
+}
+
+void ServiceApp::workerLoop() {
+    while (auto pending = request_queue_.pop()) {
+        executeRequest(*pending);
+    }
+}
 
-    } else {
-        JsonRpc::sendErrorResponse(j_request, "未知方法: '" + method + "'。");
+void ServiceApp::handleSetEncoding(const json& j_request) {
+    const json params = j_request.value("params", json::object());
+    const std::string encoding_name = params.value("encoding", "");
+    const auto mode = RpcEncoding::from_string(encoding_name);
+    if (!mode) {
+        JsonRpc::sendErrorResponse(j_request, "不支持的编码: '" + encoding_name + "'，可选值为 text、cbor、msgpack。");
+        return;
     }
+    // 响应先以旧编码入队，随后通道切换
+    JsonRpc::sendSuccessResponse(j_request, {{"encoding", RpcEncoding::to_string(*mode)}});
+    JsonRpc::setEncoding(*mode);
 }
@@ -0,0 +1,36 @@
+#include "basic/stage_pipeline.h"
+
+void StageSignal::notify() {
+    sequence_.fetch_add(1);
+    // 等待者先登记再检查序号，这里先自增再检查等待者，两者至少有一方能看到对方
+    if (waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
+}
+
+void StageSignal::close() {
+    closed_.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_all();
+}
+
+bool StageSignal::wait(uint64_t& seen) {
+    uint64_t current = sequence_.load();
+    if (current == seen && !closed_.load()) {
+        waiters_.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] {
+                current = sequence_.load();
+                return current != seen || closed_.load();
+            });
+        }
+        waiters_.fetch_sub(1);
+    }
+    if (closed_.load()) {
+        return false;
+    }
+    seen = current;
+    return true;
+}
@@ -0,0 +1,97 @@
+#include "basic/status_publisher.h"
+
+#include <algorithm>
+
+#include "basic/json_rpc.h"
+
+namespace {
+
+std::chrono::steady_clock::duration interval_for_rate(double rate_hz) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rate_hz));
+}
+
+} // namespace
+
+StatusPublisher::StatusPublisher()
+    : min_interval_(interval_for_rate(DEFAULT_MAX_RATE_HZ)) {
+    thread_ = std::thread(&StatusPublisher::publisherLoop, this);
+}
+
+StatusPublisher::~StatusPublisher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void StatusPublisher::publish(const std::string& task_name, const json& changes) {
+    if (changes.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        json& merged = pending_[task_name];
+        for (const auto& [key, value] : changes.items()) {
+            merged[key] = value;
+        }
+    }
+    cv_.notify_one();
+}
+
+double StatusPublisher::setMaxRate(double rate_hz) {
+    const double clamped = std::clamp(rate_hz, MIN_RATE_HZ, MAX_RATE_HZ);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        min_interval_ = interval_for_rate(clamped);
+    }
+    // 正在等待下一个推送窗口的线程需要按新间隔重新计算
+    cv_.notify_one();
+    return clamped;
+}
+
+double StatusPublisher::maxRate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return 1.0 / std::chrono::duration<double>(min_interval_).count();
+}
+
+void StatusPublisher::publisherLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            break;
+        }
+
+        // 距上次推送不足一个间隔时等到窗口打开，期间到达的增量会被合并
+        // 退出时不再等待，直接发出最后的状态
+        while (!stopping_) {
+            const auto next_allowed = last_sent_ + min_interval_;
+            if (std::chrono::steady_clock::now() >= next_allowed) {
+                break;
+            }
+            cv_.wait_until(lock, next_allowed);
+        }
+
+        std::map<std::string, json> batch;
+        batch.swap(pending_);
+        last_sent_ = std::chrono::steady_clock::now();
+        const uint64_t first_sequence = sequence_;
+        sequence_ += batch.size();
+
+        lock.unlock();
+        uint64_t sequence = first_sequence;
+        for (auto& [task_name, changes] : batch) {
+            JsonRpc::sendNotification("task/status", {
+                {"name", task_name},
+                {"seq", ++sequence},
+                {"changes", std::move(changes)}
+            });
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,28 @@
+#include "basic/stop_token.h"
+
+void StopToken::requestStop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stop_requested_.load(std::memory_order_relaxed)) {
+        requested_at_ = std::chrono::steady_clock::now();
+    }
+    stop_requested_.store(true, std::memory_order_release);
+    cv_.notify_all();
+}
+
+void StopToken::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_.store(false, std::memory_order_release);
+    requested_at_ = {};
+}
+
+std::chrono::steady_clock::time_point StopToken::requestedAt() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requested_at_;
+}
+
+bool StopToken::sleepUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !cv_.wait_until(lock, deadline, [this] {
+        return stop_requested_.load(std::memory_order_relaxed);
+    });
+}
@@ -0,0 +1,31 @@
+#include "basic/task_executor.h"
+
+#include <algorithm>
+
+TaskExecutor::TaskExecutor(size_t worker_count) : jobs_(JOB_QUEUE_CAPACITY) {
+    const size_t count = (std::max)(worker_count, size_t{1});
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        workers_.emplace_back(&TaskExecutor::workerLoop, this);
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    // 已提交的作业会被执行完，调用方应先停止仍在运行的任务
+    jobs_.close();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool TaskExecutor::submit(std::function<void()> job) {
+    return jobs_.tryPush(std::move(job));
+}
+
+void TaskExecutor::workerLoop() {
+    while (auto job = jobs_.pop()) {
+        (*job)();
+    }
+}
@@ -1,90 +1,508 @@
 #include "basic/task_manager.h"
 #include "tasks/hello_task.h"
 #include "tasks/fishing_task.h"
+#include "tasks/window_monitor_task.h"
 #include "io/window_handler.h"
 #include "basic/exceptions.h"
+#include "basic/json_rpc.h"
 
-TaskManager::TaskManager(std::function<void(const json&)> sender)
-    : logger_(std::make_shared<Logger>(std::move(sender))) {}
+#include <set>
+#include <utility>
 
-bool TaskManager::startTask(const std::string& task_name, const json& params) {
-    last_error_.clear();
-    if (current_task_ && current_task_->isRunning()) {
-        last_error_ = "无法启动任务 '" + task_name + "'：已有任务 '" + current_task_->getTaskName() + "' 正在运行。";
+namespace {
+
+template <typename Task>
+std::shared_ptr<BaseTask> create_task(const std::string& name) {
+    return std::make_shared<Task>(name);
+}
+
+// config.source 指定录制画面时任务不访问游戏窗口，见 FrameSource::open
+bool uses_recorded_source(const json& params) {
+    if (!params.is_object() || !params.contains("config") || !params["config"].is_object()) {
         return false;
     }
+    const json& config = params["config"];
+    return config.contains("source") && config["source"].is_object()
+        && config["source"].value("type", "live") != "live";
+}
+
+// 本次运行实际占用的资源。回放录制画面时不截图也不向游戏发送输入，可以与实时任务并行
+uint32_t required_resources(const TaskDescriptor& descriptor, const json& params) {
+    return uses_recorded_source(params) ? RESOURCE_NONE : descriptor.resources;
+}
 
-    const bool is_hello = (task_name == "hello_task");
-    const bool is_fishing = (task_name == "fishing_task");
-    if (!is_hello && !is_fishing) {
-        last_error_ = "未知任务类型：" + task_name;
+} // namespace
+
+TaskManager::TaskManager()
+    : logger_(std::make_shared<Logger>()),
+      status_publisher_(std::make_shared<StatusPublisher>()),
+      executor_(std::make_shared<TaskExecutor>(EXECUTOR_THREADS)) {
+    queue_thread_ = std::thread(&TaskManager::queueLoop, this);
+}
+
+TaskManager::~TaskManager() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_stopping_ = true;
+        pending_queue_.clear();
+    }
+    queue_cv_.notify_one();
+    if (queue_thread_.joinable()) {
+        queue_thread_.join();
+    }
+    // 任务体结束时会回调 onTaskFinished，必须在成员析构前回收任务，
+    // 任务对象析构时会等待其任务体退出，之后执行器才能安全关闭。
+    // 回调需要 task_mutex_，因此先在锁内取出引用，再在锁外析构
+    std::map<std::string, RunningTask> running;
+    {
+        std::lock_guard<std::mutex> lock(task_mutex_);
+        running.swap(running_tasks_);
+        current_task_.reset();
+    }
+    running.clear();
+    task_instances_.clear();
+    executor_.reset();
+}
+
+const std::vector<TaskDescriptor>& TaskManager::descriptors() {
+    static const std::vector<TaskDescriptor> table = {
+        {"fishing_task", "钓鱼任务", true, true, true,
+         RESOURCE_INPUT | RESOURCE_FOREGROUND | RESOURCE_CAPTURE, &create_task<FishingTask>},
+        {"hello_task", "测试任务", true, false, false,
+         RESOURCE_INPUT | RESOURCE_FOREGROUND | RESOURCE_CAPTURE, &create_task<HelloTask>},
+        {"window_monitor_task", "窗口监视", true, true, true,
+         RESOURCE_NONE, &create_task<WindowMonitorTask>},
+    };
+    return table;
+}
+
+const TaskDescriptor* TaskManager::findDescriptor(const std::string& task_name) {
+    for (const auto& descriptor : descriptors()) {
+        if (task_name == descriptor.name) {
+            return &descriptor;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<BaseTask> TaskManager::currentTask() const {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    return current_task_;
+}
+
+std::vector<std::shared_ptr<BaseTask>> TaskManager::runningTasks() const {
+    std::vector<std::shared_ptr<BaseTask>> tasks;
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    tasks.reserve(running_tasks_.size());
+    for (const auto& [name, running] : running_tasks_) {
+        tasks.push_back(running.task);
+    }
+    return tasks;
+}
+
+bool TaskManager::startTask(const std::string& task_name, const json& params, std::string& error) {
+    std::lock_guard<std::mutex> start_lock(start_mutex_);
+    error.clear();
+    const TaskDescriptor* descriptor = findDescriptor(task_name);
+    if (descriptor && (required_resources(*descriptor, params) & ResourceScheduler::EXCLUSIVE_RESOURCES)) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (queue_active_) {
+            error = "无法启动任务 '" + task_name + "'：任务队列正在执行，只能启动不占用输入与前台窗口的任务。";
+            return false;
+        }
+    }
+    return launchTaskLocked(task_name, params, false, error);
+}
+
+bool TaskManager::launchTaskLocked(const std::string& task_name, const json& params, bool from_queue, std::string& error) {
+    const TaskDescriptor* descriptor = findDescriptor(task_name);
+    if (!descriptor) {
+        error = "未知任务类型：" + task_name;
+        return false;
+    }
+
+    const auto instance = task_instances_.find(task_name);
+    std::shared_ptr<BaseTask> task = (instance != task_instances_.end()) ? instance->second : nullptr;
+    if (task && task->isRunning()) {
+        error = "无法启动任务 '" + task_name + "'：该任务已在运行。";
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(task_mutex_);
+        size_t running_count = 0;
+        for (const auto& [name, running] : running_tasks_) {
+            if (name != task_name) {
+                ++running_count;
+            }
+        }
+        if (running_count >= MAX_CONCURRENT_TASKS) {
+            error = "无法启动任务 '" + task_name + "'：同时运行的任务已达上限 "
+                + std::to_string(MAX_CONCURRENT_TASKS) + " 个。";
+            return false;
+        }
+    }
+
+    // 不占用任何资源的任务（窗口监视、回放）不操作游戏窗口，窗口不存在时也可以启动
+    const uint32_t resources = required_resources(*descriptor, params);
+    if (resources != RESOURCE_NONE) {
+        try {
+            WindowHandler::find_game_window();
+        } catch (const WindowException&) {
+            error = "未找到游戏窗口，请先打开游戏。";
+            return false;
+        }
+    }
+
+    std::string resource_error;
+    if (!resources_.tryAcquire(task_name, resources, resource_error)) {
+        error = "无法启动任务 '" + task_name + "'：" + resource_error;
         return false;
     }
 
+    if (!task) {
+        task = descriptor->create(task_name);
+        task->setExecutor(executor_);
+        task->setStatusPublisher(status_publisher_);
+        task_instances_[task_name] = task;
+    }
+
+    // 任务可能在 start 返回前就已结束，登记必须先于启动
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(task_mutex_);
+        generation = ++launch_generation_;
+        running_tasks_[task_name] = {task, generation};
+        current_task_ = task;
+    }
+    task->setFinishedCallback([this, task_name, generation, from_queue] {
+        onTaskFinished(task_name, generation, from_queue);
+    });
     try {
-        WindowHandler::find_game_window();
-    } catch (const WindowException&) {
-        last_error_ = "未找到游戏窗口，请先打开游戏。";
+        task->start(params, logger_);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(task_mutex_);
+            running_tasks_.erase(task_name);
+        }
+        resources_.release(task_name);
+        throw;
+    }
+    return true;
+}
+
+bool TaskManager::startQueue(const json& items, std::string& error) {
+    error.clear();
+    if (!items.is_array() || items.empty()) {
+        error = "任务队列为空。";
         return false;
     }
 
-    if (is_hello) {
-        current_task_ = std::make_unique<HelloTask>(task_name);
-    } else {
-        current_task_ = std::make_unique<FishingTask>(task_name);
+    std::deque<QueuedTask> queue;
+    std::vector<std::string> names;
+    std::set<std::string> seen;
+    for (size_t i = 0; i < items.size(); ++i) {
+        const json& item = items[i];
+        const std::string task_name = item.is_object() ? item.value("task_name", "") : "";
+        if (task_name.empty()) {
+            error = "任务队列第 " + std::to_string(i + 1) + " 项缺少 'task_name'。";
+            return false;
+        }
+        const TaskDescriptor* descriptor = findDescriptor(task_name);
+        if (!descriptor) {
+            error = "未知任务类型：" + task_name;
+            return false;
+        }
+        const bool is_last = (i + 1 == items.size());
+        if (descriptor->singleton && !seen.insert(task_name).second) {
+            error = "任务 '" + task_name + "' 在队列中只能出现一次。";
+            return false;
+        }
+        if (descriptor->must_last && !is_last) {
+            error = "任务 '" + task_name + "' 必须位于队列末尾。";
+            return false;
+        }
+        if (descriptor->is_looping && !is_last) {
+            error = "任务 '" + task_name + "' 会持续运行，之后的任务永远不会执行，必须位于队列末尾。";
+            return false;
+        }
+        queue.push_back({task_name, item});
+        names.push_back(task_name);
     }
 
-    current_task_->start(params, logger_);
+    uint32_t queue_resources = RESOURCE_NONE;
+    for (const auto& queued : queue) {
+        queue_resources |= required_resources(*findDescriptor(queued.name), queued.params);
+    }
+
+    std::lock_guard<std::mutex> start_lock(start_mutex_);
+    const std::string holder = resources_.findConflict(queue_resources);
+    if (!holder.empty()) {
+        error = "无法启动任务队列：任务 '" + holder + "' 正在运行并占用了队列任务需要的资源。";
+        return false;
+    }
+
+    json queue_status;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (queue_active_) {
+            error = "无法启动任务队列：已有任务队列正在执行。";
+            return false;
+        }
+        pending_queue_ = std::move(queue);
+        queue_names_ = std::move(names);
+        queue_position_ = 0;
+        ++queue_generation_;
+        queue_active_ = true;
+        queue_status = queueStatusLocked();
+    }
+    queue_cv_.notify_one();
+    notifyQueue("started", "", std::move(queue_status));
     return true;
 }
 
-bool TaskManager::stopCurrentTask() {
-    if (current_task_ && current_task_->isRunning()) {
-        current_task_->stop();
-        logger_->info("已请求停止任务 '" + current_task_->getTaskName() + "'。");
-        return true;
+void TaskManager::onTaskFinished(const std::string& task_name, uint64_t generation, bool from_queue) {
+    bool current_run = false;
+    {
+        std::lock_guard<std::mutex> lock(task_mutex_);
+        auto it = running_tasks_.find(task_name);
+        if (it != running_tasks_.end() && it->second.generation == generation) {
+            running_tasks_.erase(it);
+            current_run = true;
+        }
+    }
+    if (current_run) {
+        resources_.release(task_name);
+    }
+
+    if (from_queue) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            queue_task_running_ = false;
+        }
+        queue_cv_.notify_one();
     }
-    logger_->info("当前没有正在运行的任务。");
-    return false;
 }
 
-std::string TaskManager::getLastError() const {
-    return last_error_;
+void TaskManager::queueLoop() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        queue_cv_.wait(lock, [this] {
+            return queue_stopping_ || (queue_active_ && !queue_task_running_);
+        });
+        if (queue_stopping_) {
+            break;
+        }
+
+        if (pending_queue_.empty()) {
+            queue_active_ = false;
+            json queue_status = queueStatusLocked();
+            lock.unlock();
+            notifyQueue("finished", "", std::move(queue_status));
+            logger_->info("任务队列执行完成。");
+            lock.lock();
+            continue;
+        }
+
+        QueuedTask next = std::move(pending_queue_.front());
+        pending_queue_.pop_front();
+        ++queue_position_;
+        queue_task_running_ = true;
+        const uint64_t generation = queue_generation_;
+        lock.unlock();
+
+        std::string error;
+        bool started = false;
+        bool cancelled = false;
+        {
+            std::lock_guard<std::mutex> start_lock(start_mutex_);
+            // 等待启动锁期间队列可能已被 task/stop 清空
+            {
+                std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+                cancelled = (generation != queue_generation_);
+            }
+            if (!cancelled) {
+                started = launchTaskLocked(next.name, next.params, true, error);
+            }
+        }
+
+        lock.lock();
+        if (!started) {
+            queue_task_running_ = false;
+        }
+        if (cancelled) {
+            continue;
+        }
+        json queue_status = queueStatusLocked();
+        lock.unlock();
+        if (started) {
+            notifyQueue("running", next.name, std::move(queue_status));
+        } else {
+            logger_->error("队列任务 '" + next.name + "' 启动失败，继续执行下一个：" + error);
+            queue_status["error"] = error;
+            notifyQueue("skipped", next.name, std::move(queue_status));
+        }
+        lock.lock();
+    }
+}
+
+bool TaskManager::clearQueueLocked() {
+    json queue_status;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!queue_active_) {
+            return false;
+        }
+        pending_queue_.clear();
+        ++queue_generation_;
+        queue_active_ = false;
+        queue_status = queueStatusLocked();
+    }
+    notifyQueue("cancelled", "", std::move(queue_status));
+    return true;
+}
+
+json TaskManager::queueStatusLocked() const {
+    return {
+        {"active", queue_active_},
+        {"position", queue_position_},
+        {"total", queue_names_.size()},
+        {"tasks", queue_names_}
+    };
+}
+
+void TaskManager::notifyQueue(const char* state, const std::string& task_name, json queue_status) {
+    queue_status["state"] = state;
+    if (!task_name.empty()) {
+        queue_status["task_name"] = task_name;
+    }
+    JsonRpc::sendNotification("task/queue", queue_status);
+}
+
+bool TaskManager::stopTasks(const std::string& task_name) {
+    // 持有启动锁，保证清空队列后执行线程不会再启动新的任务
+    std::lock_guard<std::mutex> start_lock(start_mutex_);
+    const bool queue_cleared = task_name.empty() && clearQueueLocked();
+    if (queue_cleared) {
+        logger_->info("已清空剩余的任务队列。");
+    }
+
+    bool stopped = false;
+    for (const auto& task : runningTasks()) {
+        if (!task_name.empty() && task->getTaskName() != task_name) {
+            continue;
+        }
+        if (task->isRunning()) {
+            task->stop();
+            logger_->info("已请求停止任务 '" + task->getTaskName() + "'。");
+            stopped = true;
+        }
+    }
+    if (!stopped && !queue_cleared) {
+        logger_->info(task_name.empty() ? "当前没有正在运行的任务。" : "任务 '" + task_name + "' 没有在运行。");
+    }
+    return stopped || queue_cleared;
 }
 
 json TaskManager::getStatus() const {
     json status_report;
-    if (current_task_) {
-        status_report["active_task"] = current_task_->getStatus();
-        status_report["message"] = "当前活动任务 '" + current_task_->getTaskName() + "' 的状态。";
+    const auto task = currentTask();
+    if (task) {
+        status_report["active_task"] = task->getStatus();
+        status_report["message"] = "当前活动任务 '" + task->getTaskName() + "' 的状态。";
     } else {
         status_report["active_task"] = nullptr;
         status_report["message"] = "当前无活动任务。";
     }
+    json running = json::array();
+    for (const auto& running_task : runningTasks()) {
+        running.push_back(running_task->getStatus());
+    }
+    status_report["running_tasks"] = std::move(running);
+    status_report["resources"] = resources_.snapshot();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        status_report["queue"] = queueStatusLocked();
+    }
     return status_report;
 }
 
 json TaskManager::getTaskList() const {
     json tasks = json::array();
-    tasks.push_back({
-        {"name", "fishing_task"},
-        {"label", "钓鱼任务"},
-        {"queue", {
-            {"singleton", true},
-            {"must_last", true},
-            {"is_looping", true}
-        }}
-    });
-    tasks.push_back({
-        {"name", "hello_task"},
-        {"label", "测试任务"},
-        {"queue", {
-            {"singleton", true},
-            {"must_last", false},
-            {"is_looping", false}
-        }}
-    });
+    for (const auto& descriptor : descriptors()) {
+        tasks.push_back({
+            {"name", descriptor.name},
+            {"label", descriptor.label},
+            {"resources", ResourceScheduler::toJson(descriptor.resources)},
+            {"queue", {
+                {"singleton", descriptor.singleton},
+                {"must_last", descriptor.must_last},
+                {"is_looping", descriptor.is_looping}
+            }}
+        });
+    }
     json result;
     result["tasks"] = tasks;
     return result;
 }
+
+void TaskManager::registerRpcMethods(RpcRegistry& registry) {
+    registry.registerMethod("task/start", [this](const json& params) -> json {
+        const std::string task_name = params.value("task_name", "");
+        if (task_name.empty()) {
+            throw RpcException("启动任务命令缺少 'task_name' 参数。");
+        }
+
+        std::string error_message;
+        if (!startTask(task_name, params, error_message)) {
+            if (error_message.empty()) {
+                throw RpcException("启动任务 '" + task_name + "' 失败 (可能已有任务在运行)。");
+            }
+            throw RpcException(error_message);
+        }
+        return {{"message", "任务 '" + task_name + "' 已成功请求启动。"}};
+    });
+
+    // 参数：{"tasks": [{"task_name": ..., 其余为该任务的启动参数}, ...]}
+    registry.registerMethod("task/startQueue", [this](const json& params) -> json {
+        if (!params.contains("tasks")) {
+            throw RpcException("启动任务队列命令缺少 'tasks' 参数。");
+        }
+        std::string error_message;
+        if (!startQueue(params["tasks"], error_message)) {
+            throw RpcException(error_message);
+        }
+        return {
+            {"message", "任务队列已开始执行，共 " + std::to_string(params["tasks"].size()) + " 个任务。"},
+            {"total", params["tasks"].size()}
+        };
+    });
+
+    // 参数：{"task_name": 可选，省略时停止所有任务并清空队列}
+    registry.registerMethod("task/stop", [this](const json& params) -> json {
+        const std::string task_name = params.value("task_name", "");
+        if (!stopTasks(task_name)) {
+            throw RpcException("停止请求失败或当前无活动任务。");
+        }
+        if (task_name.empty()) {
+            return {{"message", "已发送停止所有任务的请求。"}};
+        }
+        return {{"message", "已发送停止任务 '" + task_name + "' 的请求。"}};
+    });
+
+    registry.registerMethod("app/getStatus", [this](const json&) {
+        return getStatus();
+    }, true);
+
+    registry.registerMethod("app/getTasks", [this](const json&) {
+        return getTaskList();
+    }, true);
+
+    // 状态变更通过 task/status 推送，此方法调整推送的最大频率
+    registry.registerMethod("app/setStatusRate", [this](const json& params) -> json {
+        if (!params.contains("max_hz") || !params["max_hz"].is_number()) {
+            throw RpcException("设置状态推送频率缺少数值参数 'max_hz'。");
+        }
+        const double applied = status_publisher_->setMaxRate(params["max_hz"].get<double>());
+        return {{"max_hz", applied}};
+    }, true);
+}
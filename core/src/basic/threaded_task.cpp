@@ -1,25 +1,60 @@
 #include "basic/threaded_task.h"
 #include <utility>
 #include <basic/exceptions.h>
+#include "basic/status_publisher.h"
+#include "basic/metrics.h"
+#include "basic/task_executor.h"
+#include <stdexcept>
 
 ThreadedTask::ThreadedTask(std::string name) : task_name_(std::move(name)) {
+    task_status_json_["name"] = task_name_;
     updateStatus("空闲", 0);
 }
 
 ThreadedTask::~ThreadedTask() {
+    stopAndWait();
+}
+
+void ThreadedTask::stopAndWait() {
     if (is_running_.load()) {
         stop();
     }
+    waitForJob();
     if (task_thread_.joinable()) {
         task_thread_.join();
     }
 }
 
+void ThreadedTask::waitForJob() {
+    std::unique_lock<std::mutex> lock(job_mutex_);
+    job_cv_.wait(lock, [this] { return !job_active_; });
+}
+
 void ThreadedTask::registerStep(StepId step_id, StepAction action) {
-    if (step_actions_.find(step_id) == step_actions_.end()) {
+    registerStep(step_id, [action = std::move(action)]() {
+        return (action && action()) ? StepResult::next() : StepResult::fail();
+    });
+}
+
+void ThreadedTask::registerStep(StepId step_id, StepFunction action, StepPolicy policy) {
+    if (step_id < 0) {
+        throw std::invalid_argument("步骤编号不能为负数：" + std::to_string(step_id));
+    }
+    if (static_cast<size_t>(step_id) >= steps_.size()) {
+        steps_.resize(static_cast<size_t>(step_id) + 1);
+    }
+    Step& step = steps_[step_id];
+    if (!step.action) {
+        step.order = workflow_sequence_.size();
         workflow_sequence_.push_back(step_id);
+        step.latency = &Metrics::instance().histogram("workflow." + task_name_ + ".step" + std::to_string(step_id));
     }
-    step_actions_[step_id] = std::move(action);
+    step.action = std::move(action);
+    step.policy = policy;
+}
+
+bool ThreadedTask::stepTimedOut() const {
+    return std::chrono::steady_clock::now() >= step_deadline_;
 }
 
 void ThreadedTask::start(const json& params, std::shared_ptr<const Logger> logger) {
@@ -27,15 +62,35 @@ void ThreadedTask::start(const json& params, std::shared_ptr<const Logger> logge
         logger->warn("任务 '" + task_name_ + "' 已经在运行中。");
         return;
     }
+    // 上一轮的任务体可能还在执行收尾（完成回调之后），等它彻底退出再复用对象
+    waitForJob();
     params_ = params;
     logger_ = std::move(logger);
-    stop_requested_ = false;
+    stop_token_.reset();
+    is_running_ = true;
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        job_active_ = true;
+    }
 
-    task_thread_ = std::thread(&ThreadedTask::run, this);
+    auto job = [this] {
+        run();
+        // 在锁内通知：等待方被唤醒后可能立即析构本对象
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        job_active_ = false;
+        job_cv_.notify_all();
+    };
+    if (executor_ && executor_->submit(job)) {
+        return;
+    }
+    if (task_thread_.joinable()) {
+        task_thread_.join();
+    }
+    task_thread_ = std::thread(std::move(job));
 }
 
 void ThreadedTask::stop() {
-    stop_requested_ = true;
+    stop_token_.requestStop();
 }
 
 std::string ThreadedTask::getTaskName() const {
@@ -51,72 +106,177 @@ json ThreadedTask::getStatus() const {
     return task_status_json_;
 }
 
+void ThreadedTask::setStatusPublisher(std::shared_ptr<StatusPublisher> publisher) {
+    json snapshot;
+    {
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        status_publisher_ = publisher;
+        snapshot = task_status_json_;
+    }
+    // 先推送一次完整状态，之后只推送增量
+    if (publisher) {
+        publisher->publish(task_name_, snapshot);
+    }
+}
+
+void ThreadedTask::setFinishedCallback(std::function<void()> callback) {
+    finished_callback_ = std::move(callback);
+}
+
+void ThreadedTask::setExecutor(std::shared_ptr<TaskExecutor> executor) {
+    executor_ = std::move(executor);
+}
+
+void ThreadedTask::finish() {
+    if (stop_token_.stopRequested()) {
+        // 从 stop() 被调用到任务线程真正退出的时间
+        static auto& stop_latency = Metrics::instance().histogram("task.stop_latency");
+        const auto latency = std::chrono::steady_clock::now() - stop_token_.requestedAt();
+        stop_latency.record(latency);
+        LOG_DEBUG(*logger_, Workflow, "任务 '{}' 在停止请求后 {} us 退出。", task_name_,
+            std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    }
+    // isRunning 变为 false 后调用方即可重新设置回调，因此先取出本轮的回调
+    const auto callback = finished_callback_;
+    is_running_ = false;
+    if (callback) {
+        callback();
+    }
+}
+
 void ThreadedTask::updateStatus(const std::string& status_text, int progress) {
-    std::lock_guard<std::mutex> lock(status_mutex_);
-    task_status_json_["name"] = task_name_;
-    task_status_json_["status"] = status_text;
-    if (progress != -1) {
-        task_status_json_["progress"] = progress;
+    json changes;
+    std::shared_ptr<StatusPublisher> publisher;
+    {
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        json& status = task_status_json_["status"];
+        if (!status.is_string() || status.get_ref<const std::string&>() != status_text) {
+            status = status_text;
+            changes["status"] = status_text;
+        }
+        if (progress != -1) {
+            json& current_progress = task_status_json_["progress"];
+            if (current_progress != progress) {
+                current_progress = progress;
+                changes["progress"] = progress;
+            }
+        }
+        publisher = status_publisher_;
+    }
+    if (publisher && !changes.is_null()) {
+        publisher->publish(task_name_, changes);
+    }
+}
+
+StepResult ThreadedTask::executeStep(StepId step_id, const Step& step) {
+    const StepPolicy& policy = step.policy;
+    step_deadline_ = policy.timeout.count() > 0
+        ? std::chrono::steady_clock::now() + policy.timeout
+        : std::chrono::steady_clock::time_point::max();
+
+    for (int attempt = 1; ; ++attempt) {
+        const auto started_at = std::chrono::steady_clock::now();
+        StepResult result = StepResult::fail();
+        try {
+            result = step.action();
+        } catch (const WindowException& e) {
+            LOG_WARN(*logger_, Workflow, "步骤 {} 第 {} 次执行出错：{}", step_id, attempt, e.what());
+            result = StepResult::retry();
+        } catch (const ScreenshotFailedException& e) {
+            LOG_WARN(*logger_, Workflow, "步骤 {} 第 {} 次执行出错：{}", step_id, attempt, e.what());
+            result = StepResult::retry();
+        } catch (const std::exception& e) {
+            LOG_ERROR(*logger_, Workflow, "步骤 {} 发生未知错误：{}", step_id, e.what());
+            step.latency->record(std::chrono::steady_clock::now() - started_at);
+            return StepResult::fail();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - started_at;
+        step.latency->record(elapsed);
+        LOG_DEBUG(*logger_, Workflow, "步骤 {} 第 {} 次执行耗时 {} ms。", step_id, attempt,
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+
+        if (result.kind() != StepResult::Kind::Retry) {
+            if (result.kind() == StepResult::Kind::Fail && !stopRequested()) {
+                LOG_ERROR(*logger_, Workflow, "步骤 {} 执行失败！任务终止。", step_id);
+            }
+            return result;
+        }
+        if (stop_token_.stopRequested()) {
+            return result;
+        }
+        if (policy.max_attempts > 0 && attempt >= policy.max_attempts) {
+            LOG_ERROR(*logger_, Workflow, "步骤 {} 已重试 {} 次仍未成功！任务终止。", step_id, attempt);
+            return StepResult::fail();
+        }
+        if (stepTimedOut()) {
+            LOG_ERROR(*logger_, Workflow, "步骤 {} 超出 {} ms 的时限！任务终止。", step_id, policy.timeout.count());
+            return StepResult::fail();
+        }
+        if (!sleepFor(policy.retry_delay)) {
+            return result;
+        }
     }
 }
 
 void ThreadedTask::run() {
-    is_running_ = true;
-    logger_->info("工作流任务 '" + task_name_ + "' 开始。");
+    StopToken::Binding stop_binding(stop_token_);
+    LOG_INFO(*logger_, Workflow, "工作流任务 '{}' 开始。", task_name_);
 
     if (workflow_sequence_.empty()) {
-        logger_->warn("任务 '" + task_name_ + "' 没有定义任何工作步骤，直接结束。");
+        LOG_WARN(*logger_, Workflow, "任务 '{}' 没有定义任何工作步骤，直接结束。", task_name_);
         updateStatus("已完成", 100);
-        is_running_ = false;
+        finish();
         return;
     }
 
-    size_t total_steps = workflow_sequence_.size();
-    for (size_t i = 0; i < total_steps; ++i) {
-        StepId current_step_id = workflow_sequence_[i];
+    const size_t total_steps = workflow_sequence_.size();
+    StepId current_step_id = workflow_sequence_.front();
+    while (true) {
+        const Step& step = steps_[current_step_id];
+        const int progress = static_cast<int>((step.order * 100.0) / total_steps);
 
-        if (stop_requested_.load()) {
-            updateStatus("已取消", static_cast<int>((i * 100.0) / total_steps));
-            logger_->warn("任务在步骤 " + std::to_string(current_step_id) + " 前被取消。");
-            goto cleanup_and_exit;
+        if (stop_token_.stopRequested()) {
+            updateStatus("已取消", progress);
+            LOG_WARN(*logger_, Workflow, "任务在步骤 {} 前被取消。", current_step_id);
+            break;
         }
+        updateStatus("运行中：步骤 " + std::to_string(current_step_id), progress);
 
-        std::string status_msg = "运行中：步骤 " + std::to_string(current_step_id);
-        updateStatus(status_msg, static_cast<int>((i * 100.0) / total_steps));
-
-        auto it = step_actions_.find(current_step_id);
-        if (it == step_actions_.end() || !(it->second)) {
-            logger_->error("步骤 " + std::to_string(current_step_id) + " 未实现！任务失败。");
-            updateStatus("失败");
-            goto cleanup_and_exit;
+        const StepResult result = executeStep(current_step_id, step);
+        if (result.kind() == StepResult::Kind::Retry) {
+            // 只有在重试等待中收到停止请求时才会带着 Retry 返回
+            updateStatus("已取消", progress);
+            LOG_WARN(*logger_, Workflow, "任务在步骤 {} 重试期间被取消。", current_step_id);
+            break;
         }
-        // 执行步骤
-        try {
-            bool success = (it->second)();
-            if (!success) {
-                logger_->error("步骤 " + std::to_string(current_step_id) + " 执行失败！任务终止。");
+        if (result.kind() == StepResult::Kind::Fail) {
+            // 等待被停止请求打断的步骤通常以失败返回，这种情况按取消处理
+            updateStatus(stopRequested() ? "已取消" : "失败");
+            break;
+        }
+
+        bool finished = (result.kind() == StepResult::Kind::Done);
+        if (result.kind() == StepResult::Kind::Next) {
+            finished = (step.order + 1 == total_steps);
+            if (!finished) {
+                current_step_id = workflow_sequence_[step.order + 1];
+            }
+        } else if (result.kind() == StepResult::Kind::Goto) {
+            const StepId target = result.target();
+            if (target < 0 || static_cast<size_t>(target) >= steps_.size() || !steps_[target].action) {
+                LOG_ERROR(*logger_, Workflow, "步骤 {} 跳转到未注册的步骤 {}！任务失败。", current_step_id, target);
                 updateStatus("失败");
-                goto cleanup_and_exit;
+                break;
             }
-        } catch (const WindowException& e) {
-            logger_->error("步骤 " + std::to_string(current_step_id) + ": " + e.what());
-            updateStatus("失败");
-            goto cleanup_and_exit;
-        } catch (const ScreenshotFailedException& e) {
-            logger_->error("步骤 " + std::to_string(current_step_id) + ": " + e.what());
-            updateStatus("失败");
-            goto cleanup_and_exit;
-        } catch(const std::exception& e) {
-            logger_->error("步骤 " + std::to_string(current_step_id) + " 发生未知错误。");
-            updateStatus("失败");
-            goto cleanup_and_exit;
+            current_step_id = target;
         }
 
+        if (finished) {
+            updateStatus("已完成", 100);
+            LOG_INFO(*logger_, Workflow, "工作流 '{}' 所有步骤执行完毕。", task_name_);
+            break;
+        }
     }
 
-    updateStatus("已完成", 100);
-    logger_->info("工作流 '" + task_name_ + "' 所有步骤执行完毕。");
-
-cleanup_and_exit:
-    is_running_ = false;
+    finish();
 }
@@ -9,14 +9,32 @@ PointMatcher::PointMatcher(double ransac_reproj_thresh, float match_distance_mul
     match_distance_multiplier(match_distance_multiplier),
     cluster_radius_factor(cluster_radius_factor) {}
 
+cv::Ptr<cv::Feature2D> PointMatcher::shared_detector() {
+    // SIFT 只保存参数，检测过程不修改自身状态，可被多个线程共享
+    static const cv::Ptr<cv::Feature2D> detector = cv::SIFT::create();
+    return detector;
+}
+
+cv::Ptr<cv::DescriptorMatcher> PointMatcher::shared_matcher() {
+    // match(query, train) 内部会克隆出临时匹配器再训练，共享实例本身不被修改
+    static const cv::Ptr<cv::DescriptorMatcher> matcher =
+        cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
+    return matcher;
+}
+
+void PointMatcher::prewarm() {
+    shared_detector();
+    shared_matcher();
+}
+
 std::vector<cv::Point2f> PointMatcher::get_points(const cv::Mat &scene_image, const cv::Mat &object_image) {
     std::vector<cv::Point2f> representative_points_all_clusters;
     cv::Mat img_object_gray, img_scene_gray;
     cv::cvtColor(object_image, img_object_gray, cv::COLOR_BGR2GRAY);
     cv::cvtColor(scene_image, img_scene_gray, cv::COLOR_BGR2GRAY);
 
-    // 初始化特征检测器和描述子提取器
-    cv::Ptr<cv::Feature2D> detector_descriptor = cv::SIFT::create();
+    // 获取特征检测器和描述子提取器
+    cv::Ptr<cv::Feature2D> detector_descriptor = shared_detector();
     if (!detector_descriptor) {
         std::cerr << "错误: 无法创建特征检测器!" << std::endl;
         return representative_points_all_clusters;
@@ -39,8 +57,7 @@ std::vector<cv::Point2f> PointMatcher::get_points(const cv::Mat &scene_image, co
     }
 
     // 使用 FLANNBASED 匹配器
-    cv::Ptr<cv::DescriptorMatcher> matcher;
-    matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
+    cv::Ptr<cv::DescriptorMatcher> matcher = shared_matcher();
     if(!matcher){
         std::cerr << "错误: 无法创建匹配器!" << std::endl;
         return representative_points_all_clusters;
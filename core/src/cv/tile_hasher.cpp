@@ -0,0 +1,161 @@
+#include "cv/tile_hasher.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int LANES = 8;
+constexpr size_t BLOCK_BYTES = LANES * sizeof(uint32_t);
+constexpr uint32_t LANE_PRIME = 0x9E3779B1u;
+constexpr uint64_t FOLD_PRIME = 0x100000001B3ull;
+constexpr uint64_t FOLD_BASIS = 0xCBF29CE484222325ull;
+
+// 把一段像素并入分块的 8 个累加器。每个累加器只依赖自己的输入，内层循环可以按 8 路并行展开
+inline void mix_segment(uint32_t* lanes, const uchar* data, size_t bytes) {
+    size_t offset = 0;
+    for (; offset + BLOCK_BYTES <= bytes; offset += BLOCK_BYTES) {
+        uint32_t words[LANES];
+        std::memcpy(words, data + offset, BLOCK_BYTES);
+        for (int k = 0; k < LANES; ++k) {
+            lanes[k] = (lanes[k] ^ words[k]) * LANE_PRIME;
+        }
+    }
+    for (int k = 0; offset < bytes; ++offset, k = (k + 1) % LANES) {
+        lanes[k] = (lanes[k] ^ data[offset]) * LANE_PRIME;
+    }
+}
+
+inline void reset_lanes(uint32_t* lanes) {
+    for (int k = 0; k < LANES; ++k) {
+        lanes[k] = static_cast<uint32_t>(k + 1) * 0x85EBCA6Bu;
+    }
+}
+
+inline uint64_t fold_lanes(const uint32_t* lanes) {
+    uint64_t hash = FOLD_BASIS;
+    for (int k = 0; k < LANES; ++k) {
+        hash = (hash ^ lanes[k]) * FOLD_PRIME;
+    }
+    return hash;
+}
+
+} // namespace
+
+TileHasher::TileHasher(int tile_size) : tile_size_((std::max)(tile_size, 1)) {}
+
+uint64_t TileHasher::update(const cv::Mat& frame) {
+    ++frame_;
+    changed_count_ = 0;
+
+    const bool reset = frame.size() != size_ || frame.type() != type_;
+    if (reset) {
+        size_ = frame.size();
+        type_ = frame.type();
+        cols_ = (size_.width + tile_size_ - 1) / tile_size_;
+        rows_ = (size_.height + tile_size_ - 1) / tile_size_;
+        hashes_.assign(static_cast<size_t>(cols_) * rows_, 0);
+        changed_at_.assign(hashes_.size(), frame_);
+        lanes_.assign(static_cast<size_t>(cols_) * LANES, 0);
+        changed_count_ = hashes_.size();
+    }
+    if (frame.empty()) {
+        return frame_;
+    }
+
+    const size_t pixel_bytes = frame.elemSize();
+    const size_t tile_bytes = static_cast<size_t>(tile_size_) * pixel_bytes;
+    const size_t row_bytes = static_cast<size_t>(size_.width) * pixel_bytes;
+
+    for (int tile_y = 0; tile_y < rows_; ++tile_y) {
+        for (int tile_x = 0; tile_x < cols_; ++tile_x) {
+            reset_lanes(&lanes_[static_cast<size_t>(tile_x) * LANES]);
+        }
+
+        // 逐行读取，一行像素依次并入该行经过的各个分块，访问顺序与内存布局一致
+        const int y_end = (std::min)((tile_y + 1) * tile_size_, size_.height);
+        for (int y = tile_y * tile_size_; y < y_end; ++y) {
+            const uchar* row = frame.ptr(y);
+            for (int tile_x = 0; tile_x < cols_; ++tile_x) {
+                const size_t begin = static_cast<size_t>(tile_x) * tile_bytes;
+                const size_t bytes = (std::min)(tile_bytes, row_bytes - begin);
+                mix_segment(&lanes_[static_cast<size_t>(tile_x) * LANES], row + begin, bytes);
+            }
+        }
+
+        for (int tile_x = 0; tile_x < cols_; ++tile_x) {
+            const size_t index = static_cast<size_t>(tile_y) * cols_ + tile_x;
+            const uint64_t hash = fold_lanes(&lanes_[static_cast<size_t>(tile_x) * LANES]);
+            if (hash != hashes_[index]) {
+                hashes_[index] = hash;
+                if (!reset) {
+                    changed_at_[index] = frame_;
+                    ++changed_count_;
+                }
+            }
+        }
+    }
+    return frame_;
+}
+
+bool TileHasher::changed(int tile_x, int tile_y) const {
+    if (tile_x < 0 || tile_y < 0 || tile_x >= cols_ || tile_y >= rows_) {
+        return true;
+    }
+    return changed_at_[static_cast<size_t>(tile_y) * cols_ + tile_x] == frame_;
+}
+
+bool TileHasher::changedSince(const cv::Rect& region, uint64_t frame) const {
+    const cv::Rect bounds(0, 0, size_.width, size_.height);
+    if (frame == 0 || region.empty() || (region & bounds) != region) {
+        return true;
+    }
+    const int x_begin = region.x / tile_size_;
+    const int y_begin = region.y / tile_size_;
+    const int x_end = (region.x + region.width - 1) / tile_size_;
+    const int y_end = (region.y + region.height - 1) / tile_size_;
+    for (int tile_y = y_begin; tile_y <= y_end; ++tile_y) {
+        for (int tile_x = x_begin; tile_x <= x_end; ++tile_x) {
+            if (changed_at_[static_cast<size_t>(tile_y) * cols_ + tile_x] > frame) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+cv::Rect TileHasher::changedBoundsSince(uint64_t frame) const {
+    cv::Rect bounds;
+    for (int tile_y = 0; tile_y < rows_; ++tile_y) {
+        for (int tile_x = 0; tile_x < cols_; ++tile_x) {
+            if (changed_at_[static_cast<size_t>(tile_y) * cols_ + tile_x] > frame) {
+                bounds = bounds | tileRect(tile_x, tile_y);
+            }
+        }
+    }
+    return bounds;
+}
+
+std::vector<cv::Rect> TileHasher::changedRegions() const {
+    std::vector<cv::Rect> regions;
+    for (int tile_y = 0; tile_y < rows_; ++tile_y) {
+        for (int tile_x = 0; tile_x < cols_; ++tile_x) {
+            if (!changed(tile_x, tile_y)) {
+                continue;
+            }
+            const cv::Rect rect = tileRect(tile_x, tile_y);
+            if (tile_x > 0 && changed(tile_x - 1, tile_y)) {
+                regions.back().width = rect.x + rect.width - regions.back().x;
+            } else {
+                regions.push_back(rect);
+            }
+        }
+    }
+    return regions;
+}
+
+cv::Rect TileHasher::tileRect(int tile_x, int tile_y) const {
+    const int x = tile_x * tile_size_;
+    const int y = tile_y * tile_size_;
+    return cv::Rect(x, y, (std::min)(tile_size_, size_.width - x), (std::min)(tile_size_, size_.height - y));
+}
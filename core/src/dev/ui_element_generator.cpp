@@ -29,6 +29,18 @@ struct Metadata {
 };
 )RAW";
 
+/**
+ * @brief 写出命名空间内所有元素的索引数组 ALL，供预热等需要遍历全部元素的场景使用。
+ */
+void writeAllArray(std::ofstream& ofs, const std::vector<std::string>& names) {
+    ofs << "// 全部元素，按生成顺序排列\n";
+    ofs << "inline const std::array<const Metadata*, " << names.size() << "> ALL = {";
+    for (size_t i = 0; i < names.size(); ++i) {
+        ofs << (i == 0 ? "\n    " : ",\n    ") << "&UI_" << names[i];
+    }
+    ofs << (names.empty() ? "};\n\n" : "\n};\n\n");
+}
+
 /**
  * @brief 校验一个字符串是否可以作为C++变量名。
  * @param name 要校验的字符串。
@@ -55,12 +67,14 @@ bool isValidVariableName(const std::string& name) {
 std::pair<int, int> generateLayouts(std::ofstream& ofs, const std::filesystem::path& layouts_dir) {
     int success_count = 0;
     int skipped_count = 0;
+    std::vector<std::string> names;
     
     ofs << "\nnamespace UILayouts {\n\n";
     ofs << LAYOUT_METADATA_STRUCT_DEFINITION << "\n\n";
 
     if (!std::filesystem::exists(layouts_dir)) {
         std::cerr << "警告: Layouts 目录不存在: " << layouts_dir.string() << std::endl;
+        writeAllArray(ofs, names);
         ofs << "} // namespace UILayouts\n";
         return {0, 0};
     }
@@ -121,12 +135,14 @@ std::pair<int, int> generateLayouts(std::ofstream& ofs, const std::filesystem::p
             ofs << "    \"" << filename_str << "\",\n";
             ofs << "    cv::Rect(" << loc.x << ", " << loc.y << ", " << loc.width << ", " << loc.height << ")\n";
             ofs << "};\n\n";
+            names.push_back(name_str);
             success_count++;
         } else {
             std::cerr << "警告 [Layout]: 在 '" << path.filename().string() << "' 中找到 " << contours.size() << " 个轮廓 (需要1个)。已跳过。\n";
             skipped_count++;
         }
     }
+    writeAllArray(ofs, names);
     ofs << "} // namespace UILayouts\n";
     return {success_count, skipped_count};
 }
@@ -138,12 +154,14 @@ std::pair<int, int> generateLayouts(std::ofstream& ofs, const std::filesystem::p
 std::pair<int, int> generateTemplates(std::ofstream& ofs, const std::filesystem::path& templates_dir) {
     int success_count = 0;
     int skipped_count = 0;
+    std::vector<std::string> names;
 
     ofs << "\nnamespace UITemplates {\n\n";
     ofs << TEMPLATE_METADATA_STRUCT_DEFINITION << "\n\n";
 
     if (!std::filesystem::exists(templates_dir)) {
         std::cerr << "警告: Templates 目录不存在: " << templates_dir.string() << std::endl;
+        writeAllArray(ofs, names);
         ofs << "} // namespace UITemplates\n";
         return {0, 0};
     }
@@ -174,8 +192,10 @@ std::pair<int, int> generateTemplates(std::ofstream& ofs, const std::filesystem:
         ofs << "    \"" << name_str << "\",\n";
         ofs << "    \"" << filename_str << "\"\n";
         ofs << "};\n\n";
+        names.push_back(name_str);
         success_count++;
     }
+    writeAllArray(ofs, names);
     ofs << "} // namespace UITemplates\n";
     return {success_count, skipped_count};
 }
@@ -209,6 +229,7 @@ int main() {
 
     // 写入头文件头部
     ofs << "#pragma once\n\n";
+    ofs << "#include <array>\n\n";
     ofs << "#include <opencv2/core/types.hpp>\n";
 
     // 生成metadata数据
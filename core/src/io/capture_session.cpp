@@ -0,0 +1,52 @@
+#include "io/capture_session.h"
+
+CaptureSession::CaptureSession(std::shared_ptr<IFrameSource> source, size_t pool_capacity)
+    : source_(std::move(source)), pool_(pool_capacity) {}
+
+FrameHandle CaptureSession::next() {
+    FrameHandle handle = pool_.acquire();
+    cv::Mat& target = handle.buffer();
+    const uchar* previous_data = target.data;
+
+    // 帧源在尺寸不变时就地写入 scratch_.image，也就是直接写进池中的缓冲区
+    scratch_.image = target;
+    bool grabbed = false;
+    try {
+        grabbed = source_->grab(scratch_);
+    } catch (...) {
+        scratch_.image.release();
+        throw;
+    }
+    if (!grabbed) {
+        scratch_.image.release();
+        return {};
+    }
+
+    if (scratch_.image.data != target.data) {
+        if (scratch_.image.u != nullptr && scratch_.image.u->refcount == 1) {
+            // 帧源新分配、且没有其他引用的缓冲区可以直接接管
+            target = scratch_.image;
+        } else {
+            scratch_.image.copyTo(target);
+            ++stats_.copies;
+        }
+    }
+    // 释放共享引用，下一次 grab 不会写进已经交给调用方的缓冲区
+    scratch_.image.release();
+
+    if (target.data != previous_data) {
+        ++stats_.reallocations;
+    }
+    ++stats_.frames;
+
+    FrameHandle::Slot& slot = handle.slot();
+    slot.timestamp = scratch_.timestamp;
+    slot.index = scratch_.index;
+    return handle;
+}
+
+CaptureSession::Stats CaptureSession::stats() const {
+    Stats result = stats_;
+    result.pool = pool_.stats();
+    return result;
+}
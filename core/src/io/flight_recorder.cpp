@@ -0,0 +1,608 @@
+#include "io/flight_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <opencv2/imgproc.hpp>
+
+#include "basic/exceptions.h"
+
+using namespace FlightLog;
+
+namespace {
+
+// 短于此长度的零字节并入字面量，避免每个零字节都产生一对游程头
+constexpr size_t MIN_ZERO_RUN = 4;
+
+void put_varint(std::vector<uint8_t>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t*& in, const uint8_t* end, size_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7) {
+        const uint8_t byte = *in++;
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t skip_zeros(const uint8_t* data, size_t begin, size_t size) {
+    size_t i = begin;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (word != 0) {
+            break;
+        }
+    }
+    while (i < size && data[i] == 0) {
+        ++i;
+    }
+    return i;
+}
+
+// 编码为若干 [零字节个数][字面量长度][字面量]
+void encode_runs(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    size_t i = 0;
+    while (i < size) {
+        const size_t literal_begin = skip_zeros(data, i, size);
+        size_t literal_end = literal_begin;
+        size_t zeros = 0;
+        while (literal_end < size) {
+            if (data[literal_end] != 0) {
+                zeros = 0;
+            } else if (++zeros >= MIN_ZERO_RUN) {
+                literal_end -= zeros - 1;
+                break;
+            }
+            ++literal_end;
+        }
+        put_varint(out, literal_begin - i);
+        put_varint(out, literal_end - literal_begin);
+        out.insert(out.end(), data + literal_begin, data + literal_end);
+        i = literal_end;
+    }
+}
+
+// 关键帧：零游程填零、字面量拷贝；差分帧：零游程保持原值、字面量异或进上一帧
+bool decode_runs(const uint8_t* in, const uint8_t* end, uint8_t* out, size_t size, bool delta) {
+    size_t written = 0;
+    while (written < size) {
+        size_t zeros = 0;
+        size_t literal = 0;
+        if (!get_varint(in, end, zeros) || !get_varint(in, end, literal)
+            || zeros > size - written || literal > size - written - zeros
+            || literal > static_cast<size_t>(end - in)) {
+            return false;
+        }
+        if (!delta) {
+            std::memset(out + written, 0, zeros);
+        }
+        written += zeros;
+        if (delta) {
+            for (size_t k = 0; k < literal; ++k) {
+                out[written + k] ^= in[k];
+            }
+        } else {
+            std::memcpy(out + written, in, literal);
+        }
+        written += literal;
+        in += literal;
+    }
+    return in == end;
+}
+
+template <typename T>
+void put_struct(std::vector<uint8_t>& out, size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+bool recordable(const cv::Mat& image) {
+    const int channels = image.channels();
+    return !image.empty() && image.depth() == CV_8U && (channels == 1 || channels == 3 || channels == 4)
+        && image.cols <= (std::numeric_limits<uint16_t>::max)()
+        && image.rows <= (std::numeric_limits<uint16_t>::max)();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// FlightRecorder
+
+FlightRecorder::FlightRecorder(const std::string& path) : FlightRecorder(path, Options{}) {}
+
+FlightRecorder::FlightRecorder(const std::string& path, Options options)
+    : path_(path),
+      options_(options),
+      origin_(Clock::now()),
+      out_(path, std::ios::binary | std::ios::trunc),
+      pool_(options.queue_capacity + 2),
+      queue_((std::max)(options.queue_capacity, static_cast<size_t>(1))) {
+    if (!out_) {
+        throw FlightRecordException("无法创建记录文件：" + path_);
+    }
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.wall_clock_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.flush();
+    if (!out_) {
+        throw FlightRecordException("写入记录文件失败：" + path_);
+    }
+    writer_ = std::thread(&FlightRecorder::writerLoop, this);
+}
+
+FlightRecorder::~FlightRecorder() {
+    close();
+}
+
+bool FlightRecorder::recordFrame(const cv::Mat& image, uint16_t stream, cv::Point origin, Clock::time_point at) {
+    if (closed_ || !recordable(image)) {
+        return false;
+    }
+    FrameHandle frame = pool_.acquire();
+    image.copyTo(frame.buffer());
+    return recordFrame(std::move(frame), stream, origin, at);
+}
+
+bool FlightRecorder::recordFrame(FrameHandle frame, uint16_t stream, cv::Point origin, Clock::time_point at) {
+    if (!frame || !recordable(frame.image())) {
+        return false;
+    }
+    Entry entry;
+    entry.type = FlightRecordType::Frame;
+    entry.stream = stream;
+    entry.timestamp_us = toMicros(at);
+    entry.origin = origin;
+    entry.frame = std::move(frame);
+    return submit(std::move(entry));
+}
+
+bool FlightRecorder::recordDetection(json data, uint16_t stream, Clock::time_point at) {
+    Entry entry;
+    entry.type = FlightRecordType::Detection;
+    entry.stream = stream;
+    entry.timestamp_us = toMicros(at);
+    entry.data = std::move(data);
+    return submit(std::move(entry));
+}
+
+bool FlightRecorder::recordInput(json action, Clock::time_point at) {
+    Entry entry;
+    entry.type = FlightRecordType::Input;
+    entry.timestamp_us = toMicros(at);
+    entry.data = std::move(action);
+    return submit(std::move(entry));
+}
+
+bool FlightRecorder::recordEvent(json event, Clock::time_point at) {
+    Entry entry;
+    entry.type = FlightRecordType::Event;
+    entry.timestamp_us = toMicros(at);
+    entry.data = std::move(event);
+    return submit(std::move(entry));
+}
+
+void FlightRecorder::close() {
+    if (closed_.exchange(true)) {
+        return;
+    }
+    queue_.close();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    out_.close();
+}
+
+FlightRecorder::Stats FlightRecorder::stats() const {
+    Stats stats;
+    stats.records = records_;
+    stats.dropped = dropped_;
+    stats.frames = frames_;
+    stats.raw_bytes = raw_bytes_;
+    stats.encoded_bytes = encoded_bytes_;
+    stats.chunks = chunks_;
+    stats.failed = failed_;
+    return stats;
+}
+
+bool FlightRecorder::submit(Entry&& entry) {
+    if (closed_) {
+        return false;
+    }
+    if (failed_ || !queue_.tryPush(std::move(entry))) {
+        ++dropped_;
+        return false;
+    }
+    return true;
+}
+
+int64_t FlightRecorder::toMicros(Clock::time_point at) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(at - origin_).count();
+}
+
+void FlightRecorder::writerLoop() {
+    while (auto entry = queue_.pop()) {
+        if (failed_) {
+            ++dropped_;
+            continue;
+        }
+        append(*entry);
+        const int64_t span_us = chunk_header_.last_us - chunk_header_.first_us;
+        if (chunk_.size() >= options_.chunk_bytes
+            || span_us >= std::chrono::duration_cast<std::chrono::microseconds>(options_.chunk_duration).count()) {
+            writeChunk();
+        }
+    }
+    if (!failed_) {
+        writeChunk();
+    }
+}
+
+void FlightRecorder::append(const Entry& entry) {
+    if (chunk_header_.record_count == 0) {
+        chunk_header_.first_us = entry.timestamp_us;
+        chunk_header_.last_us = entry.timestamp_us;
+    } else {
+        chunk_header_.first_us = (std::min)(chunk_header_.first_us, entry.timestamp_us);
+        chunk_header_.last_us = (std::max)(chunk_header_.last_us, entry.timestamp_us);
+    }
+
+    const size_t record_offset = chunk_.size();
+    chunk_.resize(record_offset + sizeof(RecordHeader));
+    if (entry.type == FlightRecordType::Frame) {
+        appendFrame(entry);
+    } else {
+        const std::string text = entry.data.dump();
+        chunk_.insert(chunk_.end(), text.begin(), text.end());
+    }
+
+    RecordHeader header = {};
+    header.type = static_cast<uint8_t>(entry.type);
+    header.stream = entry.stream;
+    header.payload_bytes = static_cast<uint32_t>(chunk_.size() - record_offset - sizeof(RecordHeader));
+    header.timestamp_us = entry.timestamp_us;
+    put_struct(chunk_, record_offset, header);
+    ++chunk_header_.record_count;
+    ++records_;
+}
+
+void FlightRecorder::appendFrame(const Entry& entry) {
+    const cv::Mat& image = entry.frame.image();
+    const int channels = image.channels();
+    const size_t row_bytes = static_cast<size_t>(image.cols) * channels;
+    const size_t frame_bytes = row_bytes * image.rows;
+
+    StreamState& state = streams_[entry.stream];
+    const bool keyframe = state.needs_keyframe || state.since_keyframe >= options_.keyframe_interval
+        || state.previous.size() != image.size() || state.previous.type() != image.type();
+
+    // 先做可逆的字节变换，使静止或平滑的区域变成零，再做零游程编码
+    scratch_.resize(frame_bytes);
+    for (int y = 0; y < image.rows; ++y) {
+        const uint8_t* row = image.ptr(y);
+        uint8_t* out = scratch_.data() + row_bytes * y;
+        if (keyframe) {
+            std::memcpy(out, row, static_cast<size_t>(channels));
+            for (size_t x = channels; x < row_bytes; ++x) {
+                out[x] = static_cast<uint8_t>(row[x] - row[x - channels]);
+            }
+        } else {
+            const uint8_t* previous = state.previous.ptr(y);
+            for (size_t x = 0; x < row_bytes; ++x) {
+                out[x] = row[x] ^ previous[x];
+            }
+        }
+    }
+
+    FrameHeader header = {};
+    header.width = static_cast<uint16_t>(image.cols);
+    header.height = static_cast<uint16_t>(image.rows);
+    header.channels = static_cast<uint8_t>(channels);
+    header.codec = static_cast<uint8_t>(keyframe ? Codec::Key : Codec::Delta);
+    header.x = entry.origin.x;
+    header.y = entry.origin.y;
+    const size_t header_offset = chunk_.size();
+    chunk_.resize(header_offset + sizeof(FrameHeader));
+    put_struct(chunk_, header_offset, header);
+    encode_runs(scratch_.data(), frame_bytes, chunk_);
+
+    image.copyTo(state.previous);
+    state.since_keyframe = keyframe ? 1 : state.since_keyframe + 1;
+    state.needs_keyframe = false;
+
+    ++frames_;
+    raw_bytes_ += frame_bytes;
+    encoded_bytes_ += chunk_.size() - header_offset;
+}
+
+void FlightRecorder::writeChunk() {
+    if (chunk_header_.record_count == 0) {
+        return;
+    }
+    std::memcpy(chunk_header_.magic, CHUNK_MAGIC, sizeof(chunk_header_.magic));
+    chunk_header_.payload_bytes = chunk_.size();
+    out_.write(reinterpret_cast<const char*>(&chunk_header_), sizeof(chunk_header_));
+    out_.write(reinterpret_cast<const char*>(chunk_.data()), static_cast<std::streamsize>(chunk_.size()));
+    // 每个分块写完即刷新，进程崩溃时已写出的分块仍然完整可读
+    out_.flush();
+    if (!out_) {
+        failed_ = true;
+        return;
+    }
+    ++chunks_;
+
+    chunk_.clear();
+    chunk_header_ = {};
+    // 每个分块都从关键帧开始，读取方可以从任意分块开始解码
+    for (auto& [stream, state] : streams_) {
+        state.needs_keyframe = true;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// FlightLogReader
+
+FlightLogReader::FlightLogReader(const std::string& path) : path_(path) {
+    if (!file_.open(path_, MappedFile::Mode::ReadOnly)) {
+        throw FlightRecordException("无法打开记录文件：" + path_);
+    }
+    const uint8_t* data = file_.data();
+    const size_t size = file_.size();
+    FileHeader header = {};
+    if (size < sizeof(header)) {
+        throw FlightRecordException("记录文件不完整：" + path_);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        throw FlightRecordException("不是有效的记录文件：" + path_);
+    }
+
+    // 只读取分块头建立索引；遇到不完整或损坏的分块即停止，之后的内容被忽略
+    size_t offset = sizeof(header);
+    while (size - offset >= sizeof(ChunkHeader)) {
+        ChunkHeader chunk = {};
+        std::memcpy(&chunk, data + offset, sizeof(chunk));
+        offset += sizeof(chunk);
+        if (std::memcmp(chunk.magic, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0 || chunk.payload_bytes > size - offset) {
+            break;
+        }
+        ChunkInfo info;
+        info.offset = offset;
+        info.record_count = chunk.record_count;
+        info.payload_bytes = chunk.payload_bytes;
+        info.first = std::chrono::microseconds(chunk.first_us);
+        info.last = std::chrono::microseconds(chunk.last_us);
+        chunks_.push_back(info);
+        offset += static_cast<size_t>(chunk.payload_bytes);
+    }
+    rewind();
+}
+
+std::chrono::microseconds FlightLogReader::startTime() const {
+    std::chrono::microseconds start = chunks_.empty() ? std::chrono::microseconds(0) : chunks_.front().first;
+    for (const ChunkInfo& chunk : chunks_) {
+        start = (std::min)(start, chunk.first);
+    }
+    return start;
+}
+
+std::chrono::microseconds FlightLogReader::endTime() const {
+    std::chrono::microseconds end = chunks_.empty() ? std::chrono::microseconds(0) : chunks_.front().last;
+    for (const ChunkInfo& chunk : chunks_) {
+        end = (std::max)(end, chunk.last);
+    }
+    return end;
+}
+
+void FlightLogReader::seek(std::chrono::microseconds timestamp) {
+    // 分块按写入顺序排列，第一个包含不早于目标时间的记录的分块即为起点
+    size_t index = 0;
+    while (index < chunks_.size() && chunks_[index].last < timestamp) {
+        ++index;
+    }
+    startChunk(index);
+    skip_before_us_ = timestamp.count();
+    skipping_ = true;
+}
+
+bool FlightLogReader::next(FlightRecord& record) {
+    while (true) {
+        if (records_left_ == 0) {
+            if (chunk_index_ + 1 >= chunks_.size()) {
+                return false;
+            }
+            startChunk(chunk_index_ + 1);
+            continue;
+        }
+        if (readRecord(record)) {
+            skipping_ = false;
+            return true;
+        }
+    }
+}
+
+void FlightLogReader::startChunk(size_t index) {
+    chunk_index_ = index;
+    if (index < chunks_.size()) {
+        offset_ = chunks_[index].offset;
+        records_left_ = chunks_[index].record_count;
+    } else {
+        records_left_ = 0;
+    }
+}
+
+bool FlightLogReader::readRecord(FlightRecord& record) {
+    const ChunkInfo& chunk = chunks_[chunk_index_];
+    const size_t chunk_end = chunk.offset + static_cast<size_t>(chunk.payload_bytes);
+    RecordHeader header = {};
+    if (chunk_end - offset_ < sizeof(header)) {
+        throw FlightRecordException("记录头超出分块范围：" + path_);
+    }
+    std::memcpy(&header, file_.data() + offset_, sizeof(header));
+    const uint8_t* payload = file_.data() + offset_ + sizeof(header);
+    if (header.payload_bytes > chunk_end - offset_ - sizeof(header)) {
+        throw FlightRecordException("记录内容超出分块范围：" + path_);
+    }
+    offset_ += sizeof(header) + header.payload_bytes;
+    --records_left_;
+
+    const auto type = static_cast<FlightRecordType>(header.type);
+    const bool skip = skipping_ && header.timestamp_us < skip_before_us_;
+    if (type == FlightRecordType::Frame) {
+        // seek 目标之前的画面也必须解码，之后的差分帧依赖它们
+        decodeFrame(payload, header.payload_bytes, header.stream, record);
+        record.data = nullptr;
+    } else if (type == FlightRecordType::Detection || type == FlightRecordType::Input
+        || type == FlightRecordType::Event) {
+        if (skip) {
+            return false;
+        }
+        record.image = cv::Mat();
+        record.data = json::parse(payload, payload + header.payload_bytes, nullptr, false);
+        if (record.data.is_discarded()) {
+            throw FlightRecordException("记录内容不是有效的 JSON：" + path_);
+        }
+    } else {
+        // 新版本增加的记录类型，跳过
+        return false;
+    }
+    record.type = type;
+    record.stream = header.stream;
+    record.timestamp = std::chrono::microseconds(header.timestamp_us);
+    return !skip;
+}
+
+void FlightLogReader::decodeFrame(const uint8_t* payload, size_t bytes, uint16_t stream, FlightRecord& record) {
+    FrameHeader header = {};
+    if (bytes < sizeof(header)) {
+        throw FlightRecordException("画面记录不完整：" + path_);
+    }
+    std::memcpy(&header, payload, sizeof(header));
+    if (header.width == 0 || header.height == 0
+        || (header.channels != 1 && header.channels != 3 && header.channels != 4)) {
+        throw FlightRecordException("画面记录的格式无效：" + path_);
+    }
+
+    cv::Mat& image = streams_[stream];
+    const int type = CV_8UC(static_cast<int>(header.channels));
+    const bool delta = header.codec == static_cast<uint8_t>(Codec::Delta);
+    if (delta) {
+        if (image.cols != header.width || image.rows != header.height || image.type() != type) {
+            throw FlightRecordException("差分帧缺少对应的关键帧：" + path_);
+        }
+    } else {
+        image.create(header.height, header.width, type);
+    }
+
+    const size_t row_bytes = static_cast<size_t>(header.width) * header.channels;
+    uint8_t* pixels = image.ptr(0);
+    if (!decode_runs(payload + sizeof(header), payload + bytes, pixels, row_bytes * header.height, delta)) {
+        throw FlightRecordException("画面数据损坏：" + path_);
+    }
+    if (!delta) {
+        for (int y = 0; y < image.rows; ++y) {
+            uint8_t* row = pixels + row_bytes * y;
+            for (size_t x = header.channels; x < row_bytes; ++x) {
+                row[x] = static_cast<uint8_t>(row[x] + row[x - header.channels]);
+            }
+        }
+    }
+    record.image = image;
+    record.origin = cv::Point(header.x, header.y);
+}
+
+// ---------------------------------------------------------------------------
+// FlightRecordSource
+
+FlightRecordSource::FlightRecordSource(const std::string& path, PlaybackOptions options, uint16_t stream)
+    : RecordedFrameSource(options), path_(path), stream_(stream), reader_(path) {}
+
+std::string FlightRecordSource::describe() const {
+    return "飞行记录 " + path_ + "（画面流 " + std::to_string(stream_) + "）";
+}
+
+bool FlightRecordSource::readNext(cv::Mat& image, std::chrono::microseconds& timestamp) {
+    while (reader_.next(record_)) {
+        if (record_.type != FlightRecordType::Frame || record_.stream != stream_) {
+            continue;
+        }
+        if (!has_first_) {
+            has_first_ = true;
+            first_ = record_.timestamp;
+        }
+        timestamp = record_.timestamp - first_;
+        // 读取方就地更新差分帧，交给调用方的必须是拷贝
+        const int channels = record_.image.channels();
+        if (channels == 4) {
+            cv::cvtColor(record_.image, image, cv::COLOR_BGRA2BGR);
+        } else if (channels == 1) {
+            cv::cvtColor(record_.image, image, cv::COLOR_GRAY2BGR);
+        } else {
+            record_.image.copyTo(image);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool FlightRecordSource::rewind() {
+    reader_.rewind();
+    return true;
+}
+
+FlightRegionReader::FlightRegionReader(const std::string& path, std::vector<uint16_t> streams)
+    : path_(path), streams_(std::move(streams)), reader_(path) {}
+
+std::string FlightRegionReader::describe() const {
+    std::string streams;
+    for (const uint16_t stream : streams_) {
+        streams += (streams.empty() ? "" : ", ") + std::to_string(stream);
+    }
+    return "飞行记录 " + path_ + "（区域画面流 " + streams + "）";
+}
+
+bool FlightRegionReader::next(Regions& regions) {
+    regions.images.resize(streams_.size());
+    regions.origins.resize(streams_.size());
+    std::vector<bool> filled(streams_.size(), false);
+    size_t filled_count = 0;
+
+    while (reader_.next(record_)) {
+        if (record_.type != FlightRecordType::Frame) {
+            continue;
+        }
+        const auto it = std::find(streams_.begin(), streams_.end(), record_.stream);
+        if (it == streams_.end()) {
+            continue;
+        }
+        const size_t index = static_cast<size_t>(it - streams_.begin());
+        // 时间戳变化或同一画面流再次出现，说明上一组不完整，从这一条重新开始
+        if (filled_count > 0 && (record_.timestamp != regions.timestamp || filled[index])) {
+            std::fill(filled.begin(), filled.end(), false);
+            filled_count = 0;
+        }
+        if (filled_count == 0) {
+            regions.timestamp = record_.timestamp;
+        }
+        // 读取方就地更新差分帧，组内的画面必须拷贝出来
+        record_.image.copyTo(regions.images[index]);
+        regions.origins[index] = record_.origin;
+        filled[index] = true;
+        if (++filled_count == streams_.size()) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#include "io/frame_pool.h"
+
+#include <algorithm>
+
+FramePool::FramePool(size_t capacity)
+    : capacity_((std::max)(capacity, size_t{1})), state_(std::make_shared<State>()) {
+    state_->slots.reserve(capacity_);
+    state_->free_slots.reserve(capacity_);
+    for (size_t i = 0; i < capacity_; ++i) {
+        state_->slots.push_back(std::make_unique<Slot>());
+        state_->free_slots.push_back(state_->slots.back().get());
+    }
+}
+
+FrameHandle FramePool::acquire() {
+    Slot* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        ++state_->stats.acquired;
+        if (state_->free_slots.empty()) {
+            ++state_->stats.overflows;
+        } else {
+            // 空闲列表中的槽位没有任何句柄持有，可以直接就地改写
+            slot = state_->free_slots.back();
+            state_->free_slots.pop_back();
+        }
+    }
+
+    if (slot == nullptr) {
+        // 临时槽位不属于池，最后一个句柄释放时直接销毁
+        return FrameHandle(std::make_shared<Slot>());
+    }
+    std::shared_ptr<State> state = state_;
+    return FrameHandle(std::shared_ptr<Slot>(slot, [state](Slot* s) { recycle(state, s); }));
+}
+
+void FramePool::recycle(const std::shared_ptr<State>& state, Slot* slot) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->free_slots.push_back(slot);
+}
+
+size_t FramePool::available() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free_slots.size();
+}
+
+FramePool::Stats FramePool::stats() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->stats;
+}
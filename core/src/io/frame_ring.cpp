@@ -0,0 +1,245 @@
+#include "io/frame_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#include <opencv2/imgproc.hpp>
+
+#include "basic/exceptions.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t steady_now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+FrameRing::FrameRing(std::string name, uint32_t slot_count, size_t slot_capacity)
+    : name_(std::move(name)),
+      slot_count_(slot_count),
+      slot_capacity_(slot_capacity),
+      slot_stride_(align_up(SLOT_HEADER_SIZE + slot_capacity, 4096)),
+      mapped_size_(RING_HEADER_SIZE + slot_stride_ * slot_count) {
+    if (slot_count_ == 0 || slot_capacity_ == 0) {
+        throw SharedMemoryException("共享内存环的槽位数或容量无效");
+    }
+
+#ifdef _WIN32
+    const std::string mapping_name = "Local\\" + name_;
+    const auto size = static_cast<unsigned long long>(mapped_size_);
+    HANDLE mapping = CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        NULL,
+        PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32),
+        static_cast<DWORD>(size & 0xFFFFFFFFull),
+        mapping_name.c_str()
+    );
+    if (mapping == NULL) {
+        throw SharedMemoryException("创建共享内存失败：" + mapping_name);
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, mapped_size_);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        throw SharedMemoryException("映射共享内存失败：" + mapping_name);
+    }
+    mapping_handle_ = mapping;
+    base_ = static_cast<unsigned char*>(view);
+#else
+    const std::string shm_name = "/" + name_;
+    shm_fd_ = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (shm_fd_ < 0) {
+        throw SharedMemoryException("创建共享内存失败：" + shm_name);
+    }
+    if (ftruncate(shm_fd_, static_cast<off_t>(mapped_size_)) != 0) {
+        close(shm_fd_);
+        shm_unlink(shm_name.c_str());
+        throw SharedMemoryException("设置共享内存大小失败：" + shm_name);
+    }
+    void* view = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_, 0);
+    if (view == MAP_FAILED) {
+        close(shm_fd_);
+        shm_unlink(shm_name.c_str());
+        throw SharedMemoryException("映射共享内存失败：" + shm_name);
+    }
+    base_ = static_cast<unsigned char*>(view);
+#endif
+
+    // 头部最后写入 magic，读取方见到 magic 即可认为布局已就绪
+    RingHeader* ring = new (base_) RingHeader();
+    ring->version = VERSION;
+    ring->slot_count = slot_count_;
+    ring->slot_capacity = slot_capacity_;
+    ring->slot_stride = slot_stride_;
+    ring->latest_sequence.store(0);
+    for (uint32_t i = 0; i < slot_count_; ++i) {
+        SlotHeader* slot = new (slotHeader(i)) SlotHeader();
+        slot->sequence.store(0);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(ring->magic, MAGIC, sizeof(MAGIC));
+}
+
+FrameRing::~FrameRing() {
+#ifdef _WIN32
+    if (base_) {
+        UnmapViewOfFile(base_);
+    }
+    if (mapping_handle_) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    }
+#else
+    if (base_) {
+        munmap(base_, mapped_size_);
+    }
+    if (shm_fd_ >= 0) {
+        close(shm_fd_);
+        shm_unlink(("/" + name_).c_str());
+    }
+#endif
+}
+
+FrameRing::RingHeader* FrameRing::header() const {
+    return reinterpret_cast<RingHeader*>(base_);
+}
+
+FrameRing::SlotHeader* FrameRing::slotHeader(uint32_t slot) const {
+    return reinterpret_cast<SlotHeader*>(base_ + RING_HEADER_SIZE + slot_stride_ * slot);
+}
+
+unsigned char* FrameRing::slotData(uint32_t slot) const {
+    return base_ + RING_HEADER_SIZE + slot_stride_ * slot + SLOT_HEADER_SIZE;
+}
+
+std::optional<FrameRing::PublishedFrame> FrameRing::publish(const cv::Mat& image) {
+    if (image.empty() || image.depth() != CV_8U) {
+        return std::nullopt;
+    }
+
+    // 超出槽位容量时等比缩小，保证任意尺寸的画面都能预览
+    cv::Mat source = image;
+    const size_t required = image.total() * image.elemSize();
+    if (required > slot_capacity_) {
+        const double scale = std::sqrt(static_cast<double>(slot_capacity_) / static_cast<double>(required));
+        const int width = (std::max)(1, static_cast<int>(image.cols * scale));
+        const int height = (std::max)(1, static_cast<int>(image.rows * scale));
+        cv::resize(image, source, cv::Size(width, height), 0.0, 0.0, cv::INTER_AREA);
+    }
+
+    const size_t row_bytes = static_cast<size_t>(source.cols) * source.elemSize();
+
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    const uint64_t sequence = next_sequence_++;
+    const auto slot_index = static_cast<uint32_t>(sequence % slot_count_);
+
+    SlotHeader* slot = slotHeader(slot_index);
+    unsigned char* data = slotData(slot_index);
+
+    slot->sequence.store(0, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (source.isContinuous()) {
+        std::memcpy(data, source.data, row_bytes * source.rows);
+    } else {
+        for (int y = 0; y < source.rows; ++y) {
+            std::memcpy(data + row_bytes * y, source.ptr(y), row_bytes);
+        }
+    }
+    slot->timestamp_us = steady_now_us();
+    slot->width = static_cast<uint32_t>(source.cols);
+    slot->height = static_cast<uint32_t>(source.rows);
+    slot->channels = static_cast<uint32_t>(source.channels());
+    slot->stride = static_cast<uint32_t>(row_bytes);
+
+    slot->sequence.store(sequence, std::memory_order_release);
+    header()->latest_sequence.store(sequence, std::memory_order_release);
+
+    PublishedFrame frame;
+    frame.slot = slot_index;
+    frame.sequence = sequence;
+    frame.offset = static_cast<uint64_t>(data - base_);
+    frame.width = source.cols;
+    frame.height = source.rows;
+    frame.channels = source.channels();
+    frame.stride = static_cast<int>(row_bytes);
+    return frame;
+}
+
+namespace FramePreview {
+
+namespace {
+std::atomic<bool> has_subscriber{false};
+} // namespace
+
+void setSubscribed(bool subscribed) {
+    has_subscriber.store(subscribed, std::memory_order_relaxed);
+}
+
+bool subscribed() {
+    return has_subscriber.load(std::memory_order_relaxed);
+}
+
+bool publish(const cv::Mat& image, const std::string& source, const Logger& logger) {
+    if (!subscribed()) {
+        return false;
+    }
+
+    static std::mutex init_mutex;
+    static std::unique_ptr<FrameRing> ring;
+    static bool init_failed = false;
+
+    FrameRing* ring_ptr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(init_mutex);
+        if (!ring && !init_failed) {
+            try {
+                ring = std::make_unique<FrameRing>(RING_NAME, RING_SLOT_COUNT, RING_SLOT_CAPACITY);
+            } catch (const SharedMemoryException& e) {
+                init_failed = true;
+                logger.warn(std::string("预览共享内存不可用，预览已禁用：") + e.what());
+            }
+        }
+        ring_ptr = ring.get();
+    }
+    if (!ring_ptr) {
+        return false;
+    }
+
+    const auto published = ring_ptr->publish(image);
+    if (!published) {
+        return false;
+    }
+
+    logger.notify("frame/preview", {
+        {"source", source},
+        {"ring", ring_ptr->name()},
+        {"ring_size", ring_ptr->mappedSize()},
+        {"slot", published->slot},
+        {"offset", published->offset},
+        {"sequence", published->sequence},
+        {"width", published->width},
+        {"height", published->height},
+        {"channels", published->channels},
+        {"stride", published->stride}
+    });
+    return true;
+}
+
+} // namespace FramePreview
@@ -0,0 +1,283 @@
+#include "io/frame_source.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "basic/exceptions.h"
+#include "basic/stop_token.h"
+
+namespace {
+
+std::chrono::microseconds from_ms(double ms) {
+    return std::chrono::microseconds(static_cast<int64_t>(std::llround(ms * 1000.0)));
+}
+
+std::string lowercase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return value;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// RecordedFrameSource
+
+bool RecordedFrameSource::grab(SourceFrame& frame) {
+    std::chrono::microseconds timestamp{0};
+    bool wrapped = false;
+    if (!readNext(frame.image, timestamp)) {
+        if (!options_.loop || next_index_ == 0 || !rewind() || !readNext(frame.image, timestamp)) {
+            return false;
+        }
+        wrapped = true;
+    }
+
+    if (wrapped) {
+        // 下一轮紧接在上一轮最后一帧之后，间隔取最近的帧间隔
+        loop_offset_ += last_timestamp_ + frame_interval_;
+    } else if (next_index_ > 0 && timestamp > last_timestamp_) {
+        frame_interval_ = timestamp - last_timestamp_;
+    }
+    last_timestamp_ = timestamp;
+    const auto playback_time = loop_offset_ + timestamp;
+
+    if (options_.pacing == PlaybackOptions::Pacing::Recorded) {
+        const auto now = std::chrono::steady_clock::now();
+        if (!started_) {
+            origin_ = now - playback_time;
+            started_ = true;
+        } else {
+            const auto due = origin_ + playback_time;
+            if (due > now && !StopToken::sleepOnCurrentThread(due - now)) {
+                return false;
+            }
+        }
+    }
+
+    frame.timestamp = playback_time;
+    frame.index = next_index_++;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PngSequenceSource
+
+PngSequenceSource::PngSequenceSource(const std::string& directory, PlaybackOptions options, double fps)
+    : RecordedFrameSource(options), directory_(directory) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(directory_, ec)) {
+        throw FrameSourceException("目录不存在：" + directory_);
+    }
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (entry.is_regular_file() && lowercase(entry.path().extension().string()) == ".png") {
+            files_.push_back(entry.path().string());
+        }
+    }
+    if (files_.empty()) {
+        throw FrameSourceException("目录中没有 PNG 文件：" + directory_);
+    }
+    std::sort(files_.begin(), files_.end());
+
+    std::ifstream timestamps_file(fs::path(directory_) / "timestamps.txt");
+    if (timestamps_file) {
+        double ms = 0.0;
+        while (timestamps_.size() < files_.size() && timestamps_file >> ms) {
+            timestamps_.push_back(from_ms(ms));
+        }
+        if (timestamps_.empty()) {
+            throw FrameSourceException("timestamps.txt 中没有有效的时间戳：" + directory_);
+        }
+        files_.resize(timestamps_.size());
+        const auto first = timestamps_.front();
+        for (auto& timestamp : timestamps_) {
+            timestamp -= first;
+        }
+    } else {
+        const double interval_ms = 1000.0 / (std::max)(fps, 1.0);
+        for (size_t i = 0; i < files_.size(); ++i) {
+            timestamps_.push_back(from_ms(interval_ms * static_cast<double>(i)));
+        }
+    }
+}
+
+std::string PngSequenceSource::describe() const {
+    return "PNG 序列 " + directory_ + "（" + std::to_string(files_.size()) + " 帧）";
+}
+
+bool PngSequenceSource::readNext(cv::Mat& image, std::chrono::microseconds& timestamp) {
+    if (position_ >= files_.size()) {
+        return false;
+    }
+    image = cv::imread(files_[position_], cv::IMREAD_COLOR);
+    if (image.empty()) {
+        throw FrameSourceException("无法读取图片：" + files_[position_]);
+    }
+    timestamp = timestamps_[position_];
+    ++position_;
+    return true;
+}
+
+bool PngSequenceSource::rewind() {
+    position_ = 0;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// VideoFileSource
+
+VideoFileSource::VideoFileSource(const std::string& path, PlaybackOptions options)
+    : RecordedFrameSource(options), path_(path) {
+    if (!capture_.open(path_)) {
+        throw FrameSourceException("无法打开视频：" + path_);
+    }
+    const double fps = capture_.get(cv::CAP_PROP_FPS);
+    if (fps > 0.0 && std::isfinite(fps)) {
+        fps_ = fps;
+    }
+}
+
+std::string VideoFileSource::describe() const {
+    return "视频 " + path_;
+}
+
+bool VideoFileSource::readNext(cv::Mat& image, std::chrono::microseconds& timestamp) {
+    if (!capture_.read(image) || image.empty()) {
+        return false;
+    }
+    if (image.channels() == 4) {
+        cv::cvtColor(image, image, cv::COLOR_BGRA2BGR);
+    } else if (image.channels() == 1) {
+        cv::cvtColor(image, image, cv::COLOR_GRAY2BGR);
+    }
+
+    // 优先使用容器中的时间戳以保留可变帧率录像的真实节奏，后端不提供时按帧率推算
+    const auto nominal = from_ms(1000.0 * static_cast<double>(position_) / fps_);
+    const double position_ms = capture_.get(cv::CAP_PROP_POS_MSEC);
+    if (position_ > 0 && position_ms > 0.0 && std::isfinite(position_ms)) {
+        timestamp = from_ms(position_ms);
+    } else {
+        timestamp = nominal;
+    }
+    ++position_;
+    return true;
+}
+
+bool VideoFileSource::rewind() {
+    position_ = 0;
+    if (capture_.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+        return true;
+    }
+    // 部分后端不支持定位，重新打开文件
+    capture_.release();
+    return capture_.open(path_);
+}
+
+// ---------------------------------------------------------------------------
+// RawDumpSource
+
+RawDumpSource::RawDumpSource(const std::string& path, PlaybackOptions options)
+    : RecordedFrameSource(options), path_(path) {
+    if (!file_.open(path_, MappedFile::Mode::CopyOnWrite)) {
+        throw FrameSourceException("无法打开转储文件：" + path_);
+    }
+    if (file_.size() < FILE_HEADER_SIZE) {
+        throw FrameSourceException("转储文件不完整：" + path_);
+    }
+    data_ = file_.data();
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0 || header_.version != VERSION) {
+        throw FrameSourceException("不是有效的转储文件：" + path_);
+    }
+    if (header_.width == 0 || header_.height == 0 || (header_.channels != 3 && header_.channels != 4)) {
+        throw FrameSourceException("转储文件的帧格式无效：" + path_);
+    }
+    frame_bytes_ = static_cast<size_t>(header_.width) * header_.height * header_.channels;
+    frame_count_ = (file_.size() - FILE_HEADER_SIZE) / (sizeof(int64_t) + frame_bytes_);
+    if (frame_count_ == 0) {
+        throw FrameSourceException("转储文件中没有完整的帧：" + path_);
+    }
+}
+
+std::string RawDumpSource::describe() const {
+    return "转储 " + path_ + "（" + std::to_string(frame_count_) + " 帧，"
+        + std::to_string(header_.width) + "x" + std::to_string(header_.height) + "）";
+}
+
+bool RawDumpSource::readNext(cv::Mat& image, std::chrono::microseconds& timestamp) {
+    if (position_ >= frame_count_) {
+        return false;
+    }
+    const size_t record_size = sizeof(int64_t) + frame_bytes_;
+    uint8_t* record = data_ + FILE_HEADER_SIZE + position_ * record_size;
+
+    int64_t first_us = 0;
+    int64_t recorded_us = 0;
+    std::memcpy(&first_us, data_ + FILE_HEADER_SIZE, sizeof(first_us));
+    std::memcpy(&recorded_us, record, sizeof(recorded_us));
+    timestamp = std::chrono::microseconds(recorded_us - first_us);
+
+    cv::Mat view(static_cast<int>(header_.height), static_cast<int>(header_.width),
+        CV_8UC(static_cast<int>(header_.channels)), record + sizeof(int64_t));
+    if (header_.channels == 4) {
+        // 直接转换进调用方的缓冲区，尺寸不变时不分配内存
+        cv::cvtColor(view, image, cv::COLOR_BGRA2BGR);
+    } else {
+        image = view;
+    }
+    ++position_;
+    return true;
+}
+
+bool RawDumpSource::rewind() {
+    position_ = 0;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// RawFrameDumpWriter
+
+RawFrameDumpWriter::RawFrameDumpWriter(const std::string& path)
+    : path_(path), out_(path, std::ios::binary | std::ios::trunc) {
+    if (!out_) {
+        throw FrameSourceException("无法创建转储文件：" + path_);
+    }
+}
+
+void RawFrameDumpWriter::write(const cv::Mat& image, std::chrono::microseconds timestamp) {
+    if (image.empty() || image.depth() != CV_8U || (image.channels() != 3 && image.channels() != 4)) {
+        throw FrameSourceException("转储只支持 8 位 BGR 或 BGRA 图像");
+    }
+    if (frames_written_ == 0) {
+        std::memcpy(header_.magic, RawDumpSource::MAGIC, sizeof(header_.magic));
+        header_.version = RawDumpSource::VERSION;
+        header_.width = static_cast<uint32_t>(image.cols);
+        header_.height = static_cast<uint32_t>(image.rows);
+        header_.channels = static_cast<uint32_t>(image.channels());
+        out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    } else if (static_cast<uint32_t>(image.cols) != header_.width
+        || static_cast<uint32_t>(image.rows) != header_.height
+        || static_cast<uint32_t>(image.channels()) != header_.channels) {
+        throw FrameSourceException("转储帧的尺寸或通道数与第一帧不一致");
+    }
+
+    const int64_t timestamp_us = timestamp.count();
+    out_.write(reinterpret_cast<const char*>(&timestamp_us), sizeof(timestamp_us));
+    const size_t row_bytes = static_cast<size_t>(image.cols) * image.elemSize();
+    for (int y = 0; y < image.rows; ++y) {
+        out_.write(reinterpret_cast<const char*>(image.ptr(y)), static_cast<std::streamsize>(row_bytes));
+    }
+    if (!out_) {
+        throw FrameSourceException("写入转储文件失败：" + path_);
+    }
+    ++frames_written_;
+}
@@ -0,0 +1,51 @@
+#include "io/frame_source.h"
+
+#include "basic/exceptions.h"
+#include "io/flight_recorder.h"
+
+// 工厂依赖实时截图（LiveFrameSource 定义在 screenshot.cpp），与平台无关的回放实现分开编译，
+// 测试程序只链接 frame_source.cpp 即可使用回放帧源
+namespace FrameSource {
+
+std::shared_ptr<IFrameSource> open(const json& spec) {
+    if (!spec.is_object()) {
+        throw FrameSourceException("帧源描述必须是对象");
+    }
+    const std::string type = spec.value("type", "live");
+    if (type == "live") {
+        return std::make_shared<LiveFrameSource>(IOBackend::from_string(spec.value("backend", "window_message")));
+    }
+
+    PlaybackOptions options;
+    const std::string pacing = spec.value("pacing", "recorded");
+    if (pacing == "fastest") {
+        options.pacing = PlaybackOptions::Pacing::Fastest;
+    } else if (pacing != "recorded") {
+        throw FrameSourceException("未知的回放节奏：" + pacing);
+    }
+    options.loop = spec.value("loop", false);
+
+    const std::string path = spec.value("path", "");
+    if (path.empty()) {
+        throw FrameSourceException("帧源 '" + type + "' 缺少 'path'");
+    }
+    if (type == "png_dir") {
+        return std::make_shared<PngSequenceSource>(path, options, spec.value("fps", 30.0));
+    }
+    if (type == "video") {
+        return std::make_shared<VideoFileSource>(path, options);
+    }
+    if (type == "raw_dump") {
+        return std::make_shared<RawDumpSource>(path, options);
+    }
+    if (type == "flight") {
+        try {
+            return std::make_shared<FlightRecordSource>(path, options, spec.value("stream", static_cast<uint16_t>(0)));
+        } catch (const FlightRecordException& e) {
+            throw FrameSourceException(e.what());
+        }
+    }
+    throw FrameSourceException("未知的帧源类型：" + type);
+}
+
+} // namespace FrameSource
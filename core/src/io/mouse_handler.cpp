@@ -11,6 +11,9 @@
 #include <random>
 #include <thread>
 
+#include "basic/frame_trace.h"
+#include "basic/metrics.h"
+#include "basic/stop_token.h"
 #include "io/window_handler.h"
 
 namespace {
@@ -89,7 +92,7 @@ void move_mouse_humanlike(const cv::Point& start_point, const cv::Point& end_poi
         const double jitter_y = (distrib(gen) * 2.0 - 1.0) * 1.5;
         const cv::Point final_pos(static_cast<int>(point_on_curve.x + jitter_x), static_cast<int>(point_on_curve.y + jitter_y));
         SetCursorPos(final_pos.x, final_pos.y);
-        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(total_duration_ms / num_steps)));
+        StopToken::sleepOnCurrentThread(std::chrono::milliseconds(static_cast<long long>(total_duration_ms / num_steps)));
     }
 }
 
@@ -154,7 +157,7 @@ void drag_via_window_messages(HWND hwnd, const cv::Point& start_point, const cv:
 
     send_cancel_mode(hwnd);
     post_window_message(hwnd, WM_MOUSEMOVE, WPARAM(0), down_pos);
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(10));
     post_window_message(hwnd, WM_LBUTTONDOWN, WPARAM(MK_LBUTTON), down_pos);
 
     cv::Point last_point = start_point;
@@ -178,12 +181,15 @@ void drag_via_window_messages(HWND hwnd, const cv::Point& start_point, const cv:
             last_point = current;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        // 停止时直接跳到终点并松开按键，不留下按下状态
+        if (!StopToken::sleepOnCurrentThread(std::chrono::milliseconds(2))) {
+            break;
+        }
     }
 
     const LPARAM up_pos = make_client_lparam(end_point);
     post_window_message(hwnd, WM_MOUSEMOVE, WPARAM(MK_LBUTTON), up_pos);
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(10));
     post_window_message(hwnd, WM_LBUTTONUP, WPARAM(0), up_pos);
 }
 
@@ -219,9 +225,9 @@ void MouseHandler::click_in_rect_with_win32(const cv::Rect& target_rect, bool in
         move_mouse_humanlike(cv::Point(current_pos_raw.x, current_pos_raw.y), target_screen_point);
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(20 + rand() % 30));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(20 + rand() % 30));
     mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(40 + rand() % 60));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(40 + rand() % 60));
     mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
 }
 
@@ -233,13 +239,16 @@ void MouseHandler::click_in_rect_with_window_message(const cv::Rect& target_rect
 
     send_cancel_mode(target.hwnd);
     post_window_message(target.hwnd, WM_MOUSEMOVE, WPARAM(0), pos);
-    std::this_thread::sleep_for(std::chrono::milliseconds(instant_move ? 6 : 12));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(instant_move ? 6 : 12));
     post_window_message(target.hwnd, WM_LBUTTONDOWN, WPARAM(MK_LBUTTON), pos);
-    std::this_thread::sleep_for(std::chrono::milliseconds(instant_move ? 6 : 12));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(instant_move ? 6 : 12));
     post_window_message(target.hwnd, WM_LBUTTONUP, WPARAM(0), pos);
 }
 
 void MouseHandler::click_in_rect_with_backend(const cv::Rect& target_rect, IOBackend::Mode backend, bool instant_move) {
+    // 耗时包含模拟人手的移动与停顿，反映一次输入动作的完整时长
+    static auto& latency = Metrics::instance().histogram("input.click");
+    ScopedLatency timer(latency);
     switch (backend) {
     case IOBackend::Mode::WindowMessage:
         click_in_rect_with_window_message(target_rect, instant_move);
@@ -249,6 +258,8 @@ void MouseHandler::click_in_rect_with_backend(const cv::Rect& target_rect, IOBac
         click_in_rect_with_win32(target_rect, instant_move);
         break;
     }
+    // 以按键抬起作为输入落地的时刻，记到当前线程绑定的帧
+    FrameTrace::inputInjected();
 }
 
 void MouseHandler::drag_with_win32(const cv::Rect& start_rect, const cv::Rect& end_rect, bool instant_move) {
@@ -277,9 +288,9 @@ void MouseHandler::drag_with_win32(const cv::Rect& start_rect, const cv::Rect& e
         move_mouse_humanlike(cv::Point(current_pos_raw.x, current_pos_raw.y), start_screen_point);
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(80 + rand() % 40));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(80 + rand() % 40));
     mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(120 + rand() % 60));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(120 + rand() % 60));
 
     if (instant_move) {
         SetCursorPos(end_screen_point.x, end_screen_point.y);
@@ -287,7 +298,7 @@ void MouseHandler::drag_with_win32(const cv::Rect& start_rect, const cv::Rect& e
         move_mouse_humanlike(start_screen_point, end_screen_point);
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(80 + rand() % 40));
+    StopToken::sleepOnCurrentThread(std::chrono::milliseconds(80 + rand() % 40));
     mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
 }
 
@@ -311,6 +322,8 @@ void MouseHandler::drag_with_window_message(const cv::Rect& start_rect, const cv
 }
 
 void MouseHandler::drag_with_backend(const cv::Rect& start_rect, const cv::Rect& end_rect, IOBackend::Mode backend, bool instant_move) {
+    static auto& latency = Metrics::instance().histogram("input.drag");
+    ScopedLatency timer(latency);
     switch (backend) {
     case IOBackend::Mode::WindowMessage:
         drag_with_window_message(start_rect, end_rect, instant_move);
@@ -320,4 +333,5 @@ void MouseHandler::drag_with_backend(const cv::Rect& start_rect, const cv::Rect&
         drag_with_win32(start_rect, end_rect, instant_move);
         break;
     }
+    FrameTrace::inputInjected();
 }
@@ -1,34 +1,115 @@
 #include "io/screenshot.h"
 
 #include <chrono>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "basic/exceptions.h"
+#include "basic/frame_trace.h"
+#include "basic/metrics.h"
+#include "basic/stop_token.h"
+#include "io/capture_session.h"
+#include "io/frame_source.h"
 #include "io/window_handler.h"
 
 namespace {
 
-cv::Mat bitmap_to_bgr(HDC hdc_mem, HBITMAP bitmap, int width, int height) {
-    cv::Mat mat(height, width, CV_8UC4);
+std::mutex source_mutex;
+std::shared_ptr<IFrameSource> override_source;    // 受 source_mutex 保护
+std::unique_ptr<CaptureSession> override_session;  // 从 override_source 取帧，受 source_mutex 保护
 
-    BITMAPINFOHEADER bi = {};
-    bi.biSize = sizeof(BITMAPINFOHEADER);
-    bi.biWidth = width;
-    bi.biHeight = -height;
-    bi.biPlanes = 1;
-    bi.biBitCount = 32;
-    bi.biCompression = BI_RGB;
+// 选入内存 DC 的兼容位图，尺寸不变时跨帧复用
+class GdiBitmap {
+public:
+    GdiBitmap() = default;
+    ~GdiBitmap() { reset(); }
 
-    if (GetDIBits(hdc_mem, bitmap, 0, height, mat.data, reinterpret_cast<BITMAPINFO*>(&bi), DIB_RGB_COLORS) == 0) {
-        return {};
+    GdiBitmap(const GdiBitmap&) = delete;
+    GdiBitmap& operator=(const GdiBitmap&) = delete;
+
+    void ensure(HDC reference, int width, int height) {
+        if (dc_ != nullptr && width == width_ && height == height_) {
+            return;
+        }
+        reset();
+        dc_ = CreateCompatibleDC(reference);
+        bitmap_ = CreateCompatibleBitmap(reference, width, height);
+        if (dc_ == nullptr || bitmap_ == nullptr) {
+            reset();
+            throw ScreenshotFailedException("failed to create capture surface");
+        }
+        previous_ = SelectObject(dc_, bitmap_);
+        width_ = width;
+        height_ = height;
     }
 
-    cv::Mat bgr;
-    cv::cvtColor(mat, bgr, cv::COLOR_BGRA2BGR);
-    return bgr;
-}
+    void reset() {
+        if (dc_ != nullptr && previous_ != nullptr) {
+            SelectObject(dc_, previous_);
+        }
+        if (bitmap_ != nullptr) {
+            DeleteObject(bitmap_);
+        }
+        if (dc_ != nullptr) {
+            DeleteDC(dc_);
+        }
+        dc_ = nullptr;
+        bitmap_ = nullptr;
+        previous_ = nullptr;
+        width_ = 0;
+        height_ = 0;
+    }
+
+    HDC dc() const { return dc_; }
+
+    // 以 BGRA 读出位图内容，bgra 尺寸匹配时就地写入
+    bool read(cv::Mat& bgra) const {
+        bgra.create(height_, width_, CV_8UC4);
+        BITMAPINFOHEADER bi = {};
+        bi.biSize = sizeof(BITMAPINFOHEADER);
+        bi.biWidth = width_;
+        bi.biHeight = -height_;
+        bi.biPlanes = 1;
+        bi.biBitCount = 32;
+        bi.biCompression = BI_RGB;
+        return GetDIBits(dc_, bitmap_, 0, height_, bgra.data, reinterpret_cast<BITMAPINFO*>(&bi), DIB_RGB_COLORS) != 0;
+    }
+
+private:
+    HDC dc_ = nullptr;
+    HBITMAP bitmap_ = nullptr;
+    HGDIOBJ previous_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+};
 
-cv::Mat capture_client_area(HWND hwnd, bool activate_window, bool allow_fallback) {
+// 截图用的 GDI 表面：客户区位图、各区域的位图与 BGRA 中转缓冲区在多次截图之间复用，
+// 只在尺寸变化时重建。窗口 DC 属于系统缓存，仍然每次获取、用完立即释放。
+// 表面不是线程安全的，每个线程或帧源各自持有一个。
+class WindowSurface {
+public:
+    // 把客户区截图以 BGR 写入 out，keep_bgra 时直接读出 BGRA、不做颜色转换；
+    // out 的尺寸与类型已匹配时就地写入，不分配内存
+    void capture(HWND hwnd, bool activate_window, bool allow_fallback, bool keep_bgra, cv::Mat& out);
+
+    // 只读出 regions（客户区坐标）内的像素写入 outputs。
+    // from_screen 为 true 时直接从屏幕拷贝各区域，否则先用 PrintWindow 绘制整个客户区
+    void captureRegions(HWND hwnd, bool from_screen, const std::vector<cv::Rect>& regions, bool keep_bgra,
+        std::vector<cv::Mat*>& outputs);
+
+private:
+    // 检查窗口状态，需要时激活窗口，返回客户区尺寸
+    static cv::Size prepare(HWND hwnd, bool activate_window);
+
+    GdiBitmap client_;
+    std::vector<std::unique_ptr<GdiBitmap>> regions_;
+    cv::Mat bgra_;
+    cv::Mat region_bgra_;  // 与整窗截图分开，交替使用时不会反复重新分配
+};
+
+cv::Size WindowSurface::prepare(HWND hwnd, bool activate_window) {
     if (!IsWindow(hwnd)) {
         throw ScreenshotFailedException("game window not found");
     }
@@ -40,7 +121,7 @@ cv::Mat capture_client_area(HWND hwnd, bool activate_window, bool allow_fallback
         ShowWindow(hwnd, SW_RESTORE);
     }
 
-    if (activate_window) {
+    if (activate_window && GetForegroundWindow() != hwnd) {
         HWND foreground = GetForegroundWindow();
         DWORD foreground_thread = GetWindowThreadProcessId(foreground, NULL);
         DWORD target_thread = GetWindowThreadProcessId(hwnd, NULL);
@@ -66,7 +147,9 @@ cv::Mat capture_client_area(HWND hwnd, bool activate_window, bool allow_fallback
             }
             ShowWindow(hwnd, SW_RESTORE);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (!StopToken::sleepOnCurrentThread(std::chrono::milliseconds(50))) {
+            break;
+        }
     }
 
     RECT client_rect;
@@ -79,51 +162,243 @@ cv::Mat capture_client_area(HWND hwnd, bool activate_window, bool allow_fallback
     if (width <= 0 || height <= 0) {
         throw ScreenshotFailedException("invalid client size");
     }
+    return cv::Size(width, height);
+}
+
+void WindowSurface::capture(HWND hwnd, bool activate_window, bool allow_fallback, bool keep_bgra, cv::Mat& out) {
+    const cv::Size client = prepare(hwnd, activate_window);
+    const int width = client.width;
+    const int height = client.height;
 
     HDC hdc_screen = GetDC(hwnd);
-    HDC hdc_mem = CreateCompatibleDC(hdc_screen);
-    HBITMAP bitmap = CreateCompatibleBitmap(hdc_screen, width, height);
-    SelectObject(hdc_mem, bitmap);
+    if (hdc_screen == nullptr) {
+        throw ScreenshotFailedException("failed to get window DC");
+    }
+    bool ok = false;
+    try {
+        client_.ensure(hdc_screen, width, height);
 
-    bool ok = PrintWindow(hwnd, hdc_mem, PW_CLIENTONLY | PW_RENDERFULLCONTENT) != 0;
-    if (!ok && allow_fallback) {
-        POINT client_origin = {0, 0};
-        ClientToScreen(hwnd, &client_origin);
+        ok = PrintWindow(hwnd, client_.dc(), PW_CLIENTONLY | PW_RENDERFULLCONTENT) != 0;
+        if (!ok && allow_fallback) {
+            POINT client_origin = {0, 0};
+            ClientToScreen(hwnd, &client_origin);
 
-        RECT window_rect;
-        GetWindowRect(hwnd, &window_rect);
+            RECT window_rect;
+            GetWindowRect(hwnd, &window_rect);
 
-        const int x_offset = client_origin.x - window_rect.left;
-        const int y_offset = client_origin.y - window_rect.top;
-        ok = BitBlt(hdc_mem, 0, 0, width, height, hdc_screen, x_offset, y_offset, SRCCOPY) != 0;
+            const int x_offset = client_origin.x - window_rect.left;
+            const int y_offset = client_origin.y - window_rect.top;
+            ok = BitBlt(client_.dc(), 0, 0, width, height, hdc_screen, x_offset, y_offset, SRCCOPY) != 0;
+        }
+    } catch (...) {
+        ReleaseDC(hwnd, hdc_screen);
+        throw;
     }
-
-    cv::Mat result = ok ? bitmap_to_bgr(hdc_mem, bitmap, width, height) : cv::Mat();
-
-    DeleteObject(bitmap);
-    DeleteDC(hdc_mem);
     ReleaseDC(hwnd, hdc_screen);
 
-    if (!ok || result.empty()) {
+    if (!ok || !client_.read(keep_bgra ? out : bgra_)) {
         throw ScreenshotFailedException("failed to capture window image");
     }
+    if (!keep_bgra) {
+        cv::cvtColor(bgra_, out, cv::COLOR_BGRA2BGR);
+    }
+}
+
+void WindowSurface::captureRegions(HWND hwnd, bool from_screen, const std::vector<cv::Rect>& regions, bool keep_bgra,
+    std::vector<cv::Mat*>& outputs) {
+    const cv::Size client = prepare(hwnd, from_screen);
+    const cv::Rect bounds(0, 0, client.width, client.height);
+    for (const cv::Rect& region : regions) {
+        if (region.empty() || (region & bounds) != region) {
+            throw ScreenshotFailedException("capture region outside client area");
+        }
+    }
+    while (regions_.size() < regions.size()) {
+        regions_.push_back(std::make_unique<GdiBitmap>());
+    }
+
+    // 屏幕拷贝从桌面 DC 的窗口位置读取；PrintWindow 先绘制整个客户区，区域再从内存 DC 读取
+    HWND dc_owner = from_screen ? NULL : hwnd;
+    HDC hdc_source = GetDC(dc_owner);
+    if (hdc_source == nullptr) {
+        throw ScreenshotFailedException("failed to get window DC");
+    }
+    bool ok = true;
+    try {
+        POINT origin = {0, 0};
+        HDC blit_source = hdc_source;
+        if (from_screen) {
+            ClientToScreen(hwnd, &origin);
+        } else {
+            client_.ensure(hdc_source, client.width, client.height);
+            ok = PrintWindow(hwnd, client_.dc(), PW_CLIENTONLY | PW_RENDERFULLCONTENT) != 0;
+            blit_source = client_.dc();
+        }
+        for (size_t i = 0; ok && i < regions.size(); ++i) {
+            const cv::Rect& region = regions[i];
+            GdiBitmap& target = *regions_[i];
+            target.ensure(hdc_source, region.width, region.height);
+            ok = BitBlt(target.dc(), 0, 0, region.width, region.height, blit_source,
+                origin.x + region.x, origin.y + region.y, SRCCOPY) != 0;
+        }
+    } catch (...) {
+        ReleaseDC(dc_owner, hdc_source);
+        throw;
+    }
+    ReleaseDC(dc_owner, hdc_source);
+
+    for (size_t i = 0; ok && i < regions.size(); ++i) {
+        // 输出 BGRA 时直接读进调用方的缓冲区，否则经中转缓冲区转换
+        if (keep_bgra) {
+            ok = regions_[i]->read(*outputs[i]);
+        } else if ((ok = regions_[i]->read(region_bgra_))) {
+            cv::cvtColor(region_bgra_, *outputs[i], cv::COLOR_BGRA2BGR);
+        }
+    }
+    if (!ok) {
+        throw ScreenshotFailedException("failed to capture window regions");
+    }
+}
+
+// 记录一次截图的耗时，失败的截图同样计入耗时并单独计数。
+// 成功的截图分配帧序号，之后在本线程上发出的输入动作可以据此计算端到端延迟
+template <typename Capture>
+void timed_capture(LatencyHistogram& latency, Capture&& capture) {
+    static auto& failures = Metrics::instance().counter("capture.failures");
+    const FrameTrace::Clock::time_point started_at = FrameTrace::Clock::now();
+    {
+        ScopedLatency timer(latency);
+        try {
+            capture();
+        } catch (const ScreenshotFailedException&) {
+            failures.add();
+            throw;
+        }
+    }
+    FrameTrace::captured(started_at);
+}
+
+// 成功截图读出的像素总数，用于比较整窗截图与区域截图搬运的数据量
+Metrics::Counter& captured_pixels() {
+    static auto& pixels = Metrics::instance().counter("capture.pixels");
+    return pixels;
+}
+
+LatencyHistogram& backend_latency(IOBackend::Mode backend) {
+    static auto& win32 = Metrics::instance().histogram("capture.win32");
+    static auto& window_message = Metrics::instance().histogram("capture.window_message");
+    return backend == IOBackend::Mode::Win32 ? win32 : window_message;
+}
+
+void capture_window(WindowSurface& surface, IOBackend::Mode backend, bool keep_bgra, cv::Mat& out) {
+    const bool win32 = backend == IOBackend::Mode::Win32;
+    const HWND hwnd = WindowHandler::find_game_window();
+    timed_capture(backend_latency(backend), [&] { surface.capture(hwnd, win32, win32, keep_bgra, out); });
+    captured_pixels().add(out.total());
+}
 
+// Screenshot 接口在各线程上共用的表面
+WindowSurface& thread_surface() {
+    thread_local WindowSurface surface;
+    return surface;
+}
+
+// 返回 cv::Mat 的接口由调用方持有结果，只能复用 GDI 表面；逐帧复用输出缓冲区请使用 CaptureSession
+cv::Mat capture_window(IOBackend::Mode backend, bool keep_bgra = false) {
+    cv::Mat result;
+    capture_window(thread_surface(), backend, keep_bgra, result);
     return result;
 }
 
+// 设置了帧源时从帧源取下一帧，返回 false 表示应实时截图
+bool capture_from_source(bool keep_bgra, cv::Mat& out) {
+    std::lock_guard<std::mutex> lock(source_mutex);
+    if (!override_source) {
+        return false;
+    }
+    static auto& latency = Metrics::instance().histogram("capture.frame_source");
+    timed_capture(latency, [&] {
+        FrameHandle frame = override_session->next();
+        if (!frame) {
+            throw ScreenshotFailedException("frame source exhausted: " + override_source->describe());
+        }
+        if (keep_bgra) {
+            cv::cvtColor(frame.image(), out, cv::COLOR_BGR2BGRA);
+        } else {
+            // 拷贝进调用方的 Mat，句柄随即释放，池中的槽位下一帧就能复用
+            frame.image().copyTo(out);
+        }
+    });
+    return true;
+}
+
+// 从帧源的画面（BGR）裁出各区域
+void crop_regions(const cv::Mat& image, const std::vector<cv::Rect>& regions, bool keep_bgra,
+    std::vector<cv::Mat*>& outputs) {
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    for (const cv::Rect& region : regions) {
+        if (region.empty() || (region & bounds) != region) {
+            throw ScreenshotFailedException("capture region outside frame");
+        }
+    }
+    for (size_t i = 0; i < regions.size(); ++i) {
+        if (keep_bgra) {
+            cv::cvtColor(image(regions[i]), *outputs[i], cv::COLOR_BGR2BGRA);
+        } else {
+            image(regions[i]).copyTo(*outputs[i]);
+        }
+    }
+}
+
+void capture_regions_into(const std::vector<cv::Rect>& regions, std::vector<cv::Mat*>& outputs,
+    const Screenshot::RegionCaptureOptions& options) {
+    static auto& latency = Metrics::instance().histogram("capture.regions");
+    uint64_t pixels = 0;
+    for (const cv::Rect& region : regions) {
+        pixels += static_cast<uint64_t>(region.area());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(source_mutex);
+        if (override_source) {
+            timed_capture(latency, [&] {
+                FrameHandle frame = override_session->next();
+                if (!frame) {
+                    throw ScreenshotFailedException("frame source exhausted: " + override_source->describe());
+                }
+                crop_regions(frame.image(), regions, options.bgra, outputs);
+            });
+            captured_pixels().add(pixels);
+            return;
+        }
+    }
+
+    const HWND hwnd = WindowHandler::find_game_window();
+    const bool from_screen = options.backend == IOBackend::Mode::Win32;
+    timed_capture(latency, [&] {
+        thread_surface().captureRegions(hwnd, from_screen, regions, options.bgra, outputs);
+    });
+    captured_pixels().add(pixels);
+}
+
 } // namespace
 
 namespace Screenshot {
 
 cv::Mat capture_with_win32() {
-    return capture_client_area(WindowHandler::find_game_window(), true, true);
+    return capture_window(IOBackend::Mode::Win32);
 }
 
 cv::Mat capture_with_window_message() {
-    return capture_client_area(WindowHandler::find_game_window(), false, false);
+    return capture_window(IOBackend::Mode::WindowMessage);
 }
 
 cv::Mat capture_with_backend(IOBackend::Mode backend) {
+    cv::Mat image;
+    if (capture_from_source(false, image)) {
+        return image;
+    }
+
     switch (backend) {
     case IOBackend::Mode::WindowMessage:
         return capture_with_window_message();
@@ -133,4 +408,74 @@ cv::Mat capture_with_backend(IOBackend::Mode backend) {
     }
 }
 
+cv::Mat capture_bgra(IOBackend::Mode backend) {
+    cv::Mat image;
+    if (!capture_from_source(true, image)) {
+        image = capture_window(backend, true);
+    }
+    return image;
+}
+
+void set_frame_source(std::shared_ptr<IFrameSource> source) {
+    std::lock_guard<std::mutex> lock(source_mutex);
+    override_session = source ? std::make_unique<CaptureSession>(source) : nullptr;
+    override_source = std::move(source);
+}
+
+std::shared_ptr<IFrameSource> frame_source() {
+    std::lock_guard<std::mutex> lock(source_mutex);
+    return override_source;
+}
+
+void capture_regions(const std::vector<cv::Rect>& regions, std::vector<cv::Mat>& outputs,
+    const RegionCaptureOptions& options) {
+    outputs.resize(regions.size());
+    std::vector<cv::Mat*> targets;
+    targets.reserve(outputs.size());
+    for (cv::Mat& output : outputs) {
+        targets.push_back(&output);
+    }
+    capture_regions_into(regions, targets, options);
+}
+
+std::vector<FrameHandle> capture_regions(const std::vector<cv::Rect>& regions, FramePool& pool,
+    const RegionCaptureOptions& options) {
+    std::vector<FrameHandle> handles;
+    std::vector<cv::Mat*> targets;
+    handles.reserve(regions.size());
+    targets.reserve(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) {
+        handles.push_back(pool.acquire());
+        targets.push_back(&handles.back().buffer());
+    }
+    capture_regions_into(regions, targets, options);
+    return handles;
+}
+
 } // namespace Screenshot
+
+struct LiveFrameSource::Surface {
+    WindowSurface window;
+};
+
+LiveFrameSource::LiveFrameSource(IOBackend::Mode backend)
+    : backend_(backend), surface_(std::make_unique<Surface>()) {}
+
+LiveFrameSource::~LiveFrameSource() = default;
+
+bool LiveFrameSource::grab(SourceFrame& frame) {
+    // 直接截取窗口，不经过 capture_with_backend，避免设置为全局帧源时递归；
+    // frame.image 尺寸未变时就地写入，配合 CaptureSession 不再逐帧分配
+    capture_window(surface_->window, backend_, false, frame.image);
+    const auto now = std::chrono::steady_clock::now();
+    if (next_index_ == 0) {
+        started_at_ = now;
+    }
+    frame.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(now - started_at_);
+    frame.index = next_index_++;
+    return true;
+}
+
+std::string LiveFrameSource::describe() const {
+    return std::string("实时截图（") + IOBackend::to_string(backend_) + "）";
+}
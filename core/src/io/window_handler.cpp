@@ -1,11 +1,13 @@
 #include <windows.h>
 
+#include <atomic>
 #include <chrono>
 #include <optional>
 #include <thread>
 
 #include "basic/base_config.h"
 #include "basic/exceptions.h"
+#include "basic/stop_token.h"
 #include "io/win_helper.h"
 #include "io/window_handler.h"
 
@@ -46,10 +48,13 @@ void apply_window_backend_mode(HWND hwnd, IOBackend::Mode backend) {
 } // namespace
 
 HWND WindowHandler::find_game_window() {
-    static HWND game_hwnd = NULL;
+    // 请求线程与任务线程会并发调用，句柄缓存需要原子访问
+    static std::atomic<HWND> cached_hwnd{NULL};
 
+    HWND game_hwnd = cached_hwnd.load();
     if (!IsWindow(game_hwnd)) {
         game_hwnd = FindWindowW(NULL, BaseConfig::GAME_WINDOW_TITLE);
+        cached_hwnd.store(game_hwnd);
     }
 
     if (game_hwnd == NULL) {
@@ -72,7 +77,7 @@ void WindowHandler::normalize_game_window(int width, int height, int x, int y, I
 
     if (IsIconic(hwnd)) {
         ShowWindow(hwnd, SW_RESTORE);
-        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        StopToken::sleepOnCurrentThread(std::chrono::milliseconds(150));
     }
 
     apply_window_style(hwnd);
@@ -145,7 +150,9 @@ void WindowHandler::normalize_game_window(int width, int height, int x, int y, I
             success = true;
             break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (!StopToken::sleepOnCurrentThread(std::chrono::milliseconds(50))) {
+            break;
+        }
     }
 
     if (!success) {
@@ -5,9 +5,20 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include "io/frame_ring.h"
+#include "io/screenshot.h"
 #include "io/window_handler.h"
 #include "basic/exceptions.h"
+#include "basic/frame_trace.h"
+#include "basic/metrics.h"
+#include "basic/stage_pipeline.h"
+#include "basic/triple_buffer.h"
+#include "cv/tile_hasher.h"
+#include "io/capture_session.h"
+#include "io/flight_recorder.h"
+#include "io/frame_source.h"
 
 using namespace cv;
 
@@ -15,6 +26,8 @@ namespace {
 struct FishingConfig {
     std::string monitor_name = "BD2 Fishing Monitor";
     bool show_monitor = true;
+    bool debug_window = false;  // 同时用 OpenCV 窗口显示监视画面，脱离 GUI 调试时使用
+    double preview_fps = 15.0;  // 监视画面的最高发布频率，不随识别帧率增长
 
     double rx = 0.395;
     double ry = 0.850;
@@ -26,6 +39,11 @@ struct FishingConfig {
     int hit_cooldown_ms = 600;
     int target_persist = 8;
     int freeze_interval_ms = 120;
+    double target_fps = 60.0;
+    bool pipelined = true;  // 截图、识别与按键分别在各自线程上执行；回放录制画面时总是串行
+    json source = nullptr;  // FrameSource::open 的描述，设置后从录制文件取画面，不操作游戏窗口；
+                            // "flight" 类型直接回放记录中的两个区域画面流
+    std::string record;     // 飞行记录文件，设置后记录截取的区域、识别结果与按键，用于复盘失败的运行
 
     Scalar yellow_low = Scalar(15, 70, 70);
     Scalar yellow_high = Scalar(40, 255, 255);
@@ -46,6 +64,8 @@ struct FishingConfig {
 };
 
 void pressSpace() {
+    static auto& latency = Metrics::instance().histogram("input.key");
+    ScopedLatency timer(latency);
     INPUT inputs[2] = {};
     inputs[0].type = INPUT_KEYBOARD;
     inputs[0].ki.wVk = VK_SPACE;
@@ -53,6 +73,7 @@ void pressSpace() {
     inputs[1].ki.wVk = VK_SPACE;
     inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
     SendInput(2, inputs, sizeof(INPUT));
+    FrameTrace::inputInjected();
 }
 
 FishingConfig loadConfig(const json& params) {
@@ -61,6 +82,8 @@ FishingConfig loadConfig(const json& params) {
 
     config.monitor_name = cfg.value("monitor_name", config.monitor_name);
     config.show_monitor = cfg.value("show_monitor", config.show_monitor);
+    config.debug_window = cfg.value("debug_window", config.debug_window);
+    config.preview_fps = cfg.value("preview_fps", config.preview_fps);
 
     const json roi = cfg.value("roi", json::object());
     config.rx = roi.value("x", config.rx);
@@ -75,9 +98,107 @@ FishingConfig loadConfig(const json& params) {
     config.hit_cooldown_ms = cfg.value("hit_cooldown_ms", config.hit_cooldown_ms);
     config.target_persist = cfg.value("target_persist", config.target_persist);
     config.freeze_interval_ms = cfg.value("freeze_interval_ms", config.freeze_interval_ms);
+    config.target_fps = cfg.value("target_fps", config.target_fps);
+    config.pipelined = cfg.value("pipelined", config.pipelined);
+    if (cfg.contains("source") && cfg["source"].is_object() && cfg["source"].value("type", "live") != "live") {
+        config.source = cfg["source"];
+    }
+    config.record = cfg.value("record", config.record);
 
     return config;
 }
+
+// 进度条区域及用于判断冰冻标记的扩展区域，坐标相对客户区
+struct BarGeometry {
+    Rect roi;
+    Rect ext;
+};
+
+bool compute_geometry(const FishingConfig& config, int win_w, int win_h, BarGeometry& geometry) {
+    if (win_w <= 0 || win_h <= 0) {
+        return false;
+    }
+    const int roi_w = static_cast<int>(win_w * config.rw);
+    const int roi_h = static_cast<int>(win_h * config.rh);
+    const int roi_x = static_cast<int>(win_w * config.rx);
+    const int roi_y = static_cast<int>(win_h * config.ry);
+    if (roi_w <= 0 || roi_h <= 0) {
+        return false;
+    }
+    const int ext_h = static_cast<int>(win_h * 0.1);
+    const int ext_y = roi_y - (ext_h - roi_h) / 2;
+    geometry.roi = Rect(roi_x, roi_y, roi_w, roi_h);
+    geometry.ext = Rect(roi_x, ext_y, roi_w, ext_h);
+    return true;
+}
+
+enum CaptureRegion : size_t {
+    REGION_BAR = 0,  // 进度条区域
+    REGION_EXT,      // 向上下扩展的区域，用于判断冰冻标记
+    REGION_COUNT,
+};
+
+struct CapturedFrame {
+    std::vector<Mat> regions;  // 按 CaptureRegion 排列，BGRA
+    ULONGLONG now = 0;
+    uint64_t epoch = 0;
+    FrameTrace trace;
+};
+
+struct FrameAnalysis {
+    Mat bar;  // 进度条区域，BGR，供监视窗口绘制；不显示监视窗口时为空
+    ULONGLONG now = 0;
+    ULONGLONG flash_end = 0;
+    uint64_t press_seq = 0;  // 累计需要按下空格的次数
+    FrameTrace press_trace;  // 最近一次使 press_seq 增加的帧，按键的端到端延迟记到这一帧
+    bool is_frozen = false;
+    bool is_blue_target = false;
+    int lock_s = -1;
+    int lock_e = -1;
+    int cur_x = -1;
+};
+
+using FishingPipeline = StagePipeline<CapturedFrame, FrameAnalysis>;
+
+// 在进度条上标注识别结果并发布到预览通道，只在预览线程上调用
+void drawMonitor(const FishingConfig& config, const FrameAnalysis& in, const Logger& logger) {
+    const int roi_w = in.bar.cols;
+    const int roi_h = in.bar.rows;
+    Mat debug_view = in.bar.clone();
+    if (in.now < in.flash_end) {
+        debug_view += Scalar(0, 80, 0);
+    }
+
+    if (in.is_frozen) {
+        putText(debug_view, "ICE", Point(2, roi_h - 5), 1, 0.6, Scalar(0, 0, 255), 1);
+    } else if (in.lock_s != -1) {
+        Scalar col = in.is_blue_target ? Scalar(255, 100, 0) : Scalar(0, 255, 0);
+        rectangle(debug_view, Rect(in.lock_s, 0, in.lock_e - in.lock_s, roi_h), col, 1);
+
+        int cur_p = in.is_blue_target ? config.blue_padding : config.yellow_padding;
+        if (in.lock_s < (roi_w * 0.2)) {
+            cur_p += 5;
+        }
+        rectangle(debug_view, Rect(in.lock_s - cur_p, 1, (in.lock_e + cur_p) - (in.lock_s - cur_p), roi_h - 2), Scalar(255, 255, 255), 1);
+
+        std::string mode = in.is_blue_target ? "T:BLUE" : "T:YELL";
+        putText(debug_view, mode, Point(2, 10), FONT_HERSHEY_SIMPLEX, 0.4, Scalar(255, 255, 255), 1);
+
+        if (in.cur_x != -1) {
+            line(debug_view, Point(in.cur_x, 0), Point(in.cur_x, roi_h), Scalar(0, 0, 255), 1);
+        }
+    }
+
+    int disp_w = 600;
+    int disp_h = static_cast<int>(disp_w * (static_cast<double>(roi_h) / roi_w));
+    Mat resized;
+    resize(debug_view, resized, Size(disp_w, disp_h), 0, 0, INTER_NEAREST);
+    FramePreview::publish(resized, config.monitor_name, logger);
+    if (config.debug_window) {
+        imshow(config.monitor_name, resized);
+        waitKey(1);
+    }
+}
 } // namespace
 
 FishingTask::FishingTask(std::string name)
@@ -87,6 +208,24 @@ FishingTask::FishingTask(std::string name)
 
 bool FishingTask::step_runLoop() {
     const FishingConfig config = loadConfig(params_);
+    // 蓝色目标闭运算的结构元素；截图用的 DC 与位图由 Screenshot 按线程缓存，任务不再持有
+    const Mat kernel = getStructuringElement(MORPH_RECT, Size(5, 5));
+
+    auto& metrics = Metrics::instance();
+    auto& frame_count = metrics.counter("fishing.frames");
+    auto& hit_count = metrics.counter("fishing.hits");
+    auto& frozen_count = metrics.counter("fishing.frozen_frames");
+    auto& static_count = metrics.counter("fishing.static_frames");
+
+    // 截图阶段的状态：窗口丢失或截图失败后递增 epoch，识别阶段据此丢弃跨越中断的跟踪状态
+    uint64_t epoch = 0;
+    auto lost = [&epoch](int delay_ms) {
+        ++epoch;
+        return FrameLoop::Action::backoff(std::chrono::milliseconds(delay_ms));
+    };
+
+    // 识别阶段的状态
+    uint64_t seen_epoch = 0;
     int last_x = -1;
     int lock_s = -1;
     int lock_e = -1;
@@ -95,40 +234,76 @@ bool FishingTask::step_runLoop() {
     ULONGLONG last_hit_time = 0;
     ULONGLONG flash_end = 0;
     ULONGLONG last_freeze_click = 0;
+    uint64_t press_seq = 0;
+    FrameTrace press_trace;
+    // 画面静止检测：上一帧没有识别到任何目标、且两块区域都没有变化时，
+    // 识别结果与状态都不会改变，可以跳过识别
+    TileHasher bar_tiles;
+    TileHasher ext_tiles;
+    bool last_idle = false;
+    // HSV 缓冲区跨帧复用，区域尺寸不变时不重新分配
+    Mat hsv;
+    Mat hsv_ext;
+
+    // 执行阶段的状态
+    uint64_t pressed_seq = 0;
+    std::chrono::steady_clock::time_point next_preview{};
+
+    // 监视画面：GUI 订阅了预览或打开了调试窗口时才需要绘制
+    auto preview_wanted = [&config] {
+        return config.show_monitor && (config.debug_window || FramePreview::subscribed());
+    };
+    const auto preview_interval = config.preview_fps > 0.0
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / config.preview_fps))
+        : std::chrono::steady_clock::duration::zero();
+    TripleBuffer<FrameAnalysis> preview_frames;
+    StageSignal preview_signal;
+
+    std::shared_ptr<IFrameSource> source;
+    std::unique_ptr<CaptureSession> session;
+    // 钓鱼任务的飞行记录只包含两个区域，不是整窗画面，按区域直接回放
+    std::unique_ptr<FlightRegionReader> flight;
+    if (!config.source.is_null() && config.source.value("type", "") == "flight") {
+        flight = std::make_unique<FlightRegionReader>(config.source.value("path", ""),
+            std::vector<uint16_t>{REGION_BAR, REGION_EXT});
+        logger_->info("钓鱼任务回放" + flight->describe() + "，不会向游戏发送按键。");
+    } else if (!config.source.is_null()) {
+        source = FrameSource::open(config.source);
+        session = std::make_unique<CaptureSession>(source);
+        logger_->info("钓鱼任务使用录制画面：" + source->describe() + "，不会向游戏发送按键。");
+    }
+    const bool replaying = flight || source;
+    const bool send_input = !flight && (!source || source->isLive());
 
-    HDC hdc_mem = NULL;
-    HDC hdc_ext = NULL;
-    HBITMAP h_bitmap = NULL;
-    HBITMAP h_bit_ext = NULL;
-    int last_w = 0;
-    int last_h = 0;
-
-    Mat kernel = getStructuringElement(MORPH_RECT, Size(5, 5));
-
-    if (config.show_monitor) {
-        namedWindow(config.monitor_name, WINDOW_AUTOSIZE);
+    std::unique_ptr<FlightRecorder> recorder;
+    if (!config.record.empty()) {
+        recorder = std::make_unique<FlightRecorder>(config.record);
+        logger_->info("钓鱼任务记录到：" + config.record);
     }
 
     logger_->info("钓鱼任务开始。");
 
-    while (!stop_requested_.load()) {
-        ULONGLONG now = GetTickCount64();
+    FishingPipeline::Stages stages;
+
+    std::vector<Rect> regions(REGION_COUNT);
+    Screenshot::RegionCaptureOptions region_options;
+    region_options.backend = IOBackend::Mode::Win32;
+    region_options.bgra = true;
 
+    stages.capture = [&](const FrameLoop::Frame& frame, CapturedFrame& out) {
         HWND hwnd = NULL;
         try {
             hwnd = WindowHandler::find_game_window();
         } catch (const WindowException&) {
-            last_x = -1;
-            lock_timer = 0;
-            Sleep(500);
-            continue;
+            return lost(500);
         }
 
         if (IsIconic(hwnd)) {
             ShowWindow(hwnd, SW_RESTORE);
         }
-        {
-            HWND foreground = GetForegroundWindow();
+        // 按键通过 SendInput 发送，需要游戏窗口在前台；只在失去前台时重新激活并等待窗口稳定
+        HWND foreground = GetForegroundWindow();
+        if (foreground != hwnd) {
             DWORD foregroundThreadId = GetWindowThreadProcessId(foreground, NULL);
             DWORD targetThreadId = GetWindowThreadProcessId(hwnd, NULL);
             if (foregroundThreadId != targetThreadId) {
@@ -139,89 +314,159 @@ bool FishingTask::step_runLoop() {
             if (foregroundThreadId != targetThreadId) {
                 AttachThreadInput(foregroundThreadId, targetThreadId, FALSE);
             }
+            return FrameLoop::Action::backoff(std::chrono::milliseconds(50));
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
         RECT rc;
         if (!GetClientRect(hwnd, &rc)) {
-            last_x = -1;
-            lock_timer = 0;
-            Sleep(200);
-            continue;
+            return lost(200);
         }
-        int win_w = rc.right - rc.left;
-        int win_h = rc.bottom - rc.top;
-        if (win_w <= 0 || win_h <= 0) {
-            last_x = -1;
-            lock_timer = 0;
-            Sleep(200);
-            continue;
+        BarGeometry geometry;
+        if (!compute_geometry(config, rc.right - rc.left, rc.bottom - rc.top, geometry)) {
+            return lost(200);
         }
-        int roi_w = static_cast<int>(win_w * config.rw);
-        int roi_h = static_cast<int>(win_h * config.rh);
-        int roi_x = static_cast<int>(win_w * config.rx);
-        int roi_y = static_cast<int>(win_h * config.ry);
-        if (roi_w <= 0 || roi_h <= 0) {
-            last_x = -1;
-            lock_timer = 0;
-            Sleep(200);
-            continue;
+        const Rect bounds(0, 0, rc.right - rc.left, rc.bottom - rc.top);
+        regions[REGION_BAR] = geometry.roi;
+        regions[REGION_EXT] = geometry.ext & bounds;
+
+        // 窗口已在前台，直接从屏幕拷贝两个小区域，不绘制整个客户区
+        try {
+            Screenshot::capture_regions(regions, out.regions, region_options);
+        } catch (const WindowException&) {
+            return lost(500);
+        } catch (const ScreenshotFailedException&) {
+            return lost(50);
         }
-        POINT pt = {0, 0};
-        ClientToScreen(hwnd, &pt);
-
-        int ext_h = static_cast<int>(win_h * 0.1);
-        int ext_y = roi_y - (ext_h - roi_h) / 2;
-
-        if (!hdc_mem || roi_w != last_w || roi_h != last_h) {
-            if (hdc_mem) {
-                DeleteDC(hdc_mem);
-                DeleteObject(h_bitmap);
-                DeleteDC(hdc_ext);
-                DeleteObject(h_bit_ext);
-            }
-            HDC hdc_s = GetDC(NULL);
-            hdc_mem = CreateCompatibleDC(hdc_s);
-            h_bitmap = CreateCompatibleBitmap(hdc_s, roi_w, roi_h);
-            SelectObject(hdc_mem, h_bitmap);
-            hdc_ext = CreateCompatibleDC(hdc_s);
-            h_bit_ext = CreateCompatibleBitmap(hdc_s, roi_w, ext_h);
-            SelectObject(hdc_ext, h_bit_ext);
-            ReleaseDC(NULL, hdc_s);
-            last_w = roi_w;
-            last_h = roi_h;
+        // capture_regions 已分配全局帧序号，起点为截图开始的时刻，不含窗口与前台检查
+        out.trace = FrameTrace::lastCaptured();
+        if (recorder) {
+            recorder->recordFrame(out.regions[REGION_BAR], REGION_BAR, regions[REGION_BAR].tl(), frame.started);
+            recorder->recordFrame(out.regions[REGION_EXT], REGION_EXT, regions[REGION_EXT].tl(), frame.started);
         }
 
-        HDC hdc_s = GetDC(NULL);
-        BitBlt(hdc_mem, 0, 0, roi_w, roi_h, hdc_s, pt.x + roi_x, pt.y + roi_y, SRCCOPY);
-        BitBlt(hdc_ext, 0, 0, roi_w, ext_h, hdc_s, pt.x + roi_x, pt.y + ext_y, SRCCOPY);
-        ReleaseDC(NULL, hdc_s);
+        out.now = static_cast<ULONGLONG>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(frame.started.time_since_epoch()).count());
+        out.epoch = epoch;
+        frame_count.add();
+        return FrameLoop::Action::next();
+    };
+
+    // 回放录制画面：按画面尺寸裁出与实时截图相同的区域，时间取录制时间戳，
+    // 冷却与冰冻点击间隔因此在快速回放时同样按录制时间计算
+    if (source) {
+        stages.capture = [&](const FrameLoop::Frame& loop_frame, CapturedFrame& out) {
+            const FrameTrace::Clock::time_point capture_start = FrameTrace::Clock::now();
+            const FrameHandle frame = session->next();
+            if (!frame) {
+                return FrameLoop::Action::stop();
+            }
+            const Mat& image = frame.image();
+            BarGeometry geometry;
+            const Rect bounds(0, 0, image.cols, image.rows);
+            if (!compute_geometry(config, image.cols, image.rows, geometry)
+                || (geometry.roi & bounds) != geometry.roi) {
+                throw FrameSourceException("画面尺寸 " + std::to_string(image.cols) + "x"
+                    + std::to_string(image.rows) + " 无法容纳进度条区域");
+            }
+            out.regions.resize(REGION_COUNT);
+            cvtColor(image(geometry.roi), out.regions[REGION_BAR], COLOR_BGR2BGRA);
+            cvtColor(image(geometry.ext & bounds), out.regions[REGION_EXT], COLOR_BGR2BGRA);
+            out.trace = FrameTrace::captured(capture_start);
+            if (recorder) {
+                recorder->recordFrame(out.regions[REGION_BAR], REGION_BAR, geometry.roi.tl(), loop_frame.started);
+                recorder->recordFrame(out.regions[REGION_EXT], REGION_EXT, (geometry.ext & bounds).tl(), loop_frame.started);
+            }
+            out.now = static_cast<ULONGLONG>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(frame.timestamp()).count());
+            out.epoch = epoch;
+            frame_count.add();
+            return FrameLoop::Action::next();
+        };
+    }
 
-        Mat raw(roi_h, roi_w, CV_8UC4);
-        BITMAPINFOHEADER bi = {sizeof(BITMAPINFOHEADER), roi_w, -roi_h, 1, 32, BI_RGB};
-        if (GetDIBits(hdc_mem, h_bitmap, 0, roi_h, raw.data, reinterpret_cast<BITMAPINFO*>(&bi), DIB_RGB_COLORS) == 0 || raw.empty()) {
+    // 回放飞行记录：区域与记录时截取的完全相同，位置取自记录，不再按画面尺寸计算
+    FlightRegionReader::Regions replayed;
+    const bool pace_recorded = flight && config.source.value("pacing", "recorded") != "fastest";
+    std::chrono::steady_clock::time_point replay_origin{};
+    if (flight) {
+        stages.capture = [&](const FrameLoop::Frame& loop_frame, CapturedFrame& out) {
+            FrameTrace::Clock::time_point capture_start = FrameTrace::Clock::now();
+            if (!flight->next(replayed)) {
+                return FrameLoop::Action::stop();
+            }
+            if (pace_recorded) {
+                if (replay_origin == std::chrono::steady_clock::time_point{}) {
+                    replay_origin = std::chrono::steady_clock::now() - replayed.timestamp;
+                } else if (!stopToken().sleepUntil(replay_origin + replayed.timestamp)) {
+                    return FrameLoop::Action::stop();
+                }
+                // 按录制节奏等待的时间不计入截图阶段
+                capture_start = FrameTrace::Clock::now();
+            }
+            out.regions.resize(REGION_COUNT);
+            for (size_t i = 0; i < REGION_COUNT; ++i) {
+                const Mat& image = replayed.images[i];
+                if (image.channels() == 4) {
+                    image.copyTo(out.regions[i]);
+                } else {
+                    cvtColor(image, out.regions[i], image.channels() == 1 ? COLOR_GRAY2BGRA : COLOR_BGR2BGRA);
+                }
+            }
+            out.trace = FrameTrace::captured(capture_start);
+            if (recorder) {
+                recorder->recordFrame(out.regions[REGION_BAR], REGION_BAR, replayed.origins[REGION_BAR], loop_frame.started);
+                recorder->recordFrame(out.regions[REGION_EXT], REGION_EXT, replayed.origins[REGION_EXT], loop_frame.started);
+            }
+            out.now = static_cast<ULONGLONG>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(replayed.timestamp).count());
+            out.epoch = epoch;
+            frame_count.add();
+            return FrameLoop::Action::next();
+        };
+    }
+
+    stages.analyze = [&](const CapturedFrame& in, FrameAnalysis& out) {
+        const ULONGLONG now = in.now;
+        const Mat& raw = in.regions[REGION_BAR];
+        const Mat& raw_ext = in.regions[REGION_EXT];
+        const int roi_w = raw.cols;
+        const int roi_h = raw.rows;
+        const int ext_h = raw_ext.rows;
+
+        if (in.epoch != seen_epoch) {
+            seen_epoch = in.epoch;
             last_x = -1;
             lock_timer = 0;
-            Sleep(50);
-            continue;
         }
-        Mat bar;
-        Mat hsv;
-        cvtColor(raw, bar, COLOR_BGRA2BGR);
-        cvtColor(bar, hsv, COLOR_BGR2HSV);
-
-        Mat raw_ext(ext_h, roi_w, CV_8UC4);
-        BITMAPINFOHEADER bi_e = {sizeof(BITMAPINFOHEADER), roi_w, -ext_h, 1, 32, BI_RGB};
-        if (GetDIBits(hdc_ext, h_bit_ext, 0, ext_h, raw_ext.data, reinterpret_cast<BITMAPINFO*>(&bi_e), DIB_RGB_COLORS) == 0 || raw_ext.empty()) {
-            last_x = -1;
-            lock_timer = 0;
-            Sleep(50);
-            continue;
+
+        // 识别直接从 BGRA 转换到 HSV，只有监视画面需要 BGR 的进度条
+        if (preview_wanted()) {
+            cvtColor(raw, out.bar, COLOR_BGRA2BGR);
+        } else {
+            out.bar.release();
         }
-        Mat bar_ext;
-        Mat hsv_ext;
-        cvtColor(raw_ext, bar_ext, COLOR_BGRA2BGR);
-        cvtColor(bar_ext, hsv_ext, COLOR_BGR2HSV);
+
+        const bool bar_static = bar_tiles.update(raw) > 1 && bar_tiles.changedCount() == 0;
+        const bool ext_static = ext_tiles.update(raw_ext) > 1 && ext_tiles.changedCount() == 0;
+        if (last_idle && bar_static && ext_static) {
+            static_count.add();
+            out.now = now;
+            out.flash_end = flash_end;
+            out.press_seq = press_seq;
+            out.is_frozen = false;
+            out.is_blue_target = is_blue_target;
+            out.lock_s = lock_s;
+            out.lock_e = lock_e;
+            out.cur_x = -1;
+            out.press_trace = press_trace;
+            return true;
+        }
+
+        FrameTrace trace = in.trace;
+        const uint64_t press_before = press_seq;
+        cvtColor(raw, hsv, COLOR_BGR2HSV);  // 4 通道输入时忽略 alpha
+        cvtColor(raw_ext, hsv_ext, COLOR_BGR2HSV);
+        trace.mark(FrameTrace::CONVERT);
 
         int cur_x = -1;
         bool is_frozen = false;
@@ -255,10 +500,11 @@ bool FishingTask::step_runLoop() {
 
         if (is_frozen) {
             if (now - last_freeze_click >= static_cast<ULONGLONG>(config.freeze_interval_ms)) {
-                pressSpace();
+                ++press_seq;
                 last_freeze_click = now;
             }
             last_x = -1;
+            frozen_count.add();
         } else {
             bool found_yellow = false;
             int best_area = 0;
@@ -353,12 +599,13 @@ bool FishingTask::step_runLoop() {
                 }
 
                 if (hit) {
-                    pressSpace();
+                    ++press_seq;
+                    hit_count.add();
                     last_hit_time = now;
                     flash_end = now + 150;
                     last_x = -1;
                     lock_timer = 0;
-                    logger_->info(is_blue_target ? "【蓝色命中】" : "【黄色命中】");
+                    LOG_THROTTLED(*logger_, Info, Vision, 500, "【{}命中】", is_blue_target ? "蓝色" : "黄色");
                 }
             }
 
@@ -367,52 +614,113 @@ bool FishingTask::step_runLoop() {
             }
         }
 
-        if (config.show_monitor) {
-            Mat debug_view = bar.clone();
-            if (now < flash_end) {
-                debug_view += Scalar(0, 80, 0);
-            }
-
-            if (is_frozen) {
-                putText(debug_view, "ICE", Point(2, roi_h - 5), 1, 0.6, Scalar(0, 0, 255), 1);
-            } else if (lock_s != -1) {
-                Scalar col = is_blue_target ? Scalar(255, 100, 0) : Scalar(0, 255, 0);
-                rectangle(debug_view, Rect(lock_s, 0, lock_e - lock_s, roi_h), col, 1);
-
-                int cur_p = is_blue_target ? config.blue_padding : config.yellow_padding;
-                if (lock_s < (roi_w * 0.2)) {
-                    cur_p += 5;
-                }
-                rectangle(debug_view, Rect(lock_s - cur_p, 1, (lock_e + cur_p) - (lock_s - cur_p), roi_h - 2), Scalar(255, 255, 255), 1);
-
-                std::string mode = is_blue_target ? "T:BLUE" : "T:YELL";
-                putText(debug_view, mode, Point(2, 10), FONT_HERSHEY_SIMPLEX, 0.4, Scalar(255, 255, 255), 1);
+        last_idle = !is_frozen && cur_x == -1 && lock_s == -1 && lock_timer == 0;
+        trace.mark(FrameTrace::DETECT);
+        if (press_seq != press_before) {
+            press_trace = trace;
+        }
+        if (recorder) {
+            recorder->recordDetection({{"frame", trace.frameId()}, {"now", now}, {"cur_x", cur_x}, {"lock_s", lock_s},
+                {"lock_e", lock_e}, {"frozen", is_frozen}, {"blue", is_blue_target}, {"press_seq", press_seq}});
+        }
 
-                if (cur_x != -1) {
-                    line(debug_view, Point(cur_x, 0), Point(cur_x, roi_h), Scalar(0, 0, 255), 1);
+        out.now = now;
+        out.flash_end = flash_end;
+        out.press_seq = press_seq;
+        out.is_frozen = is_frozen;
+        out.is_blue_target = is_blue_target;
+        out.lock_s = lock_s;
+        out.lock_e = lock_e;
+        out.cur_x = cur_x;
+        out.press_trace = press_trace;
+        return true;
+    };
+
+    stages.act = [&](const FrameAnalysis& in) {
+        // 流水线模式下中间的识别结果可能被跳过，按键以计数传递：
+        // 两次执行之间识别阶段累计了几次按键就补发几次，不会因此遗漏
+        if (in.press_seq != pressed_seq) {
+            const uint64_t presses = in.press_seq - pressed_seq;
+            pressed_seq = in.press_seq;
+            // 按键记到最近触发它的帧，第一次 pressSpace 发出后记录各阶段的端到端延迟
+            FrameTrace trace = in.press_trace;
+            trace.mark(FrameTrace::DECIDE);
+            FrameTrace::Binding binding(trace);
+            if (send_input) {
+                for (uint64_t i = 0; i < presses; ++i) {
+                    pressSpace();
                 }
             }
-
-            int disp_w = 600;
-            int disp_h = static_cast<int>(disp_w * (static_cast<double>(roi_h) / roi_w));
-            Mat resized;
-            resize(debug_view, resized, Size(disp_w, disp_h), 0, 0, INTER_NEAREST);
-            imshow(config.monitor_name, resized);
-            waitKey(1);
-        } else {
-            Sleep(1);
+            if (recorder) {
+                recorder->recordInput({{"key", "space"}, {"frame", trace.frameId()}, {"press_seq", in.press_seq},
+                    {"count", presses}, {"sent", send_input}});
+            }
         }
-    }
 
+        // 监视画面只在有人查看时准备，并按 preview_fps 限速；绘制与发布在预览线程上进行
+        if (!preview_wanted() || in.bar.empty()) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_preview) {
+            return;
+        }
+        next_preview = now + preview_interval;
+        // 识别阶段会在同一块内存上转换后续的帧，进度条需要深拷贝
+        FrameAnalysis& slot = preview_frames.writeBuffer();
+        Mat bar = std::move(slot.bar);
+        in.bar.copyTo(bar);
+        slot = in;
+        slot.bar = std::move(bar);
+        preview_frames.publish();
+        preview_signal.notify();
+    };
+
+    FrameLoop::Options loop_options;
+    // 录制画面由帧源按录制节奏或尽快产出，外层循环不再限速
+    loop_options.target_hz = replaying ? 0.0 : config.target_fps;
+    // 流水线模式下分析跟不上时会丢弃中间帧，结果随调度变化。回放用于回归对比，
+    // 强制串行执行，保证同一份录制每次都逐帧得到相同的识别结果
+    FishingPipeline pipeline(stopToken(), "fishing", loop_options, config.pipelined && !replaying);
+
+    // 预览线程只处理最新的一帧，绘制、缩放、发布与调试窗口都不占用按键所在的执行阶段
+    std::thread preview_thread;
     if (config.show_monitor) {
-        destroyWindow(config.monitor_name);
+        preview_thread = std::thread([&] {
+            uint64_t seen = 0;
+            while (preview_signal.wait(seen)) {
+                if (preview_frames.update()) {
+                    drawMonitor(config, preview_frames.readBuffer(), *logger_);
+                }
+            }
+            if (config.debug_window) {
+                destroyWindow(config.monitor_name);
+            }
+        });
     }
-
-    if (hdc_mem) {
-        DeleteDC(hdc_mem);
-        DeleteObject(h_bitmap);
-        DeleteDC(hdc_ext);
-        DeleteObject(h_bit_ext);
+    auto stop_preview = [&] {
+        preview_signal.close();
+        if (preview_thread.joinable()) {
+            preview_thread.join();
+        }
+    };
+    try {
+        pipeline.run(stages);
+    } catch (...) {
+        stop_preview();
+        throw;
+    }
+    stop_preview();
+
+    if (recorder) {
+        recorder->close();
+        const FlightRecorder::Stats stats = recorder->stats();
+        logger_->info("飞行记录已写入 " + std::to_string(stats.records) + " 条，丢弃 "
+            + std::to_string(stats.dropped) + " 条，画面 " + std::to_string(stats.raw_bytes / 1024) + " KB 压缩为 "
+            + std::to_string(stats.encoded_bytes / 1024) + " KB。");
+        if (stats.failed) {
+            logger_->warn("写入飞行记录失败：" + config.record);
+        }
     }
 
     logger_->info("钓鱼任务已停止。");
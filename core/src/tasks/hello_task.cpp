@@ -11,8 +11,9 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "automator/ui_automator.h"
 #include "io/backend.h"
-#include "io/mouse_handler.h"
+#include "io/frame_ring.h"
 #include "io/screenshot.h"
 #include "io/window_handler.h"
 
@@ -80,20 +81,44 @@ std::string format_benchmark_line(const std::string& name, const CaptureBenchmar
     return oss.str();
 }
 
+const UILayouts::Metadata* find_layout(const std::string& name) {
+    for (const UILayouts::Metadata* layout : UILayouts::ALL) {
+        if (name == layout->name) {
+            return layout;
+        }
+    }
+    return nullptr;
+}
+
+const UITemplates::Metadata* find_template(const std::string& name) {
+    for (const UITemplates::Metadata* template_ : UITemplates::ALL) {
+        if (name == template_->name) {
+            return template_;
+        }
+    }
+    return nullptr;
+}
+
 } // namespace
 
 HelloTask::HelloTask(std::string name)
     : ThreadedTask(std::move(name)) {
     registerStep(SETUP_WINDOW, std::bind(&HelloTask::step_setupWindow, this));
     registerStep(WAIT_A_BIT, std::bind(&HelloTask::step_waitABit, this));
-    registerStep(SHOT_BEFORE, std::bind(&HelloTask::step_shotBefore, this));
+    // 窗口刚恢复或切换后端时偶尔会截到空图，截图步骤允许短暂重试
+    const StepPolicy capture_policy{3, std::chrono::milliseconds(200), std::chrono::seconds(5)};
+    registerStep(SHOT_BEFORE, std::bind(&HelloTask::step_shotBefore, this), capture_policy);
     registerStep(TEST_INPUT, std::bind(&HelloTask::step_testInput, this));
-    registerStep(SHOT_AFTER, std::bind(&HelloTask::step_shotAfter, this));
+    registerStep(SHOT_AFTER, std::bind(&HelloTask::step_shotAfter, this), capture_policy);
     registerStep(BENCHMARK_CAPTURE, std::bind(&HelloTask::step_benchmarkCapture, this));
     registerStep(SHOW_IMAGE, std::bind(&HelloTask::step_showImage, this));
     registerStep(CLEANUP_RESOURCES, std::bind(&HelloTask::step_cleanup, this));
 }
 
+HelloTask::~HelloTask() {
+    stopAndWait();
+}
+
 bool HelloTask::step_setupWindow() {
     logger_->info("[Step] Checking game window...");
 
@@ -127,56 +152,103 @@ bool HelloTask::step_setupWindow() {
 
 bool HelloTask::step_waitABit() {
     const int wait_seconds = 10;
+
+    const std::string wait_layout = params_.value("wait_layout", std::string());
+    const std::string wait_template = params_.value("wait_template", std::string());
+    const UILayouts::Metadata* layout = find_layout(wait_layout);
+    const UITemplates::Metadata* template_ = find_template(wait_template);
+    if ((!wait_layout.empty() && !layout) || (!wait_template.empty() && !template_)) {
+        logger_->warn("[Step] Unknown wait_layout/wait_template, falling back to the countdown.");
+    }
+    if (layout || template_) {
+        return waitForTarget(layout, template_, std::chrono::seconds(wait_seconds));
+    }
+
     logger_->info("[Step] Waiting 10 seconds before test...");
 
     for (int i = 0; i < wait_seconds; ++i) {
-        if (stop_requested_.load()) {
+        logger_->info("[Step] Countdown: " + std::to_string(wait_seconds - i) + "s");
+        if (!sleepFor(std::chrono::seconds(1))) {
             return false;
         }
-        logger_->info("[Step] Countdown: " + std::to_string(wait_seconds - i) + "s");
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        cv::waitKey(1);
     }
     return true;
 }
 
-bool HelloTask::step_shotBefore() {
+bool HelloTask::waitForTarget(
+    const UILayouts::Metadata* layout,
+    const UITemplates::Metadata* template_,
+    std::chrono::milliseconds timeout
+) {
+    const auto io_backend = IOBackend::from_string(params_.value("io_backend", std::string("window_message")));
+    const auto poll_interval = std::chrono::milliseconds(params_.value("wait_poll_ms", 200));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    logger_->info("[Step] Waiting for the target to appear, up to " + std::to_string(timeout.count() / 1000) + "s...");
+
+    // 等待期间画面大多静止，ScreenContext 复用上次的匹配结果，只在变化的区域附近重新搜索
+    UIAutomator::ScreenContext screen;
+    int polls = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        screen.update(Screenshot::capture_bgra(io_backend));
+        ++polls;
+        if (layout && screen.verify(*layout)) {
+            click_rect_ = layout->location;
+            logger_->info(std::string("[Step] Layout matched after ") + std::to_string(polls) + " captures: " + layout->name);
+            return true;
+        }
+        if (template_) {
+            if (const auto found = screen.find(*template_)) {
+                click_rect_ = *found;
+                logger_->info(std::string("[Step] Template found after ") + std::to_string(polls) + " captures: " + template_->name);
+                return true;
+            }
+        }
+        if (!sleepFor(poll_interval)) {
+            return false;
+        }
+    }
+    logger_->warn("[Step] Target did not appear, keeping the configured click rect.");
+    return true;
+}
+
+StepResult HelloTask::step_shotBefore() {
     const auto io_backend = IOBackend::from_string(params_.value("io_backend", std::string("window_message")));
     logger_->info(std::string("[Step] Capturing BEFORE image with backend: ") + IOBackend::to_string(io_backend));
 
-    captured_before_ = Screenshot::capture_with_backend(io_backend);
+    // 截图保持 BGRA，对比图直接在 BGRA 上标注与拼接，整个测试不做颜色转换
+    captured_before_ = Screenshot::capture_bgra(io_backend);
     if (captured_before_.empty()) {
-        logger_->error("Before image is empty.");
-        return false;
+        logger_->warn("Before image is empty.");
+        return StepResult::retry();
     }
-    return true;
+    return StepResult::next();
 }
 
 bool HelloTask::step_testInput() {
     const auto io_backend = IOBackend::from_string(params_.value("io_backend", std::string("window_message")));
     logger_->info("[Step] Sending background click to the test region...");
 
-    MouseHandler::click_in_rect_with_backend(click_rect_, io_backend, true);
-    std::this_thread::sleep_for(std::chrono::milliseconds(params_.value("post_click_wait_ms", 500)));
-    return true;
+    // 点击记到 BEFORE 截图所在的帧上，端到端延迟按阶段计入 e2e.*
+    UIAutomator::click_in_rect(click_rect_, io_backend, true);
+    return sleepFor(std::chrono::milliseconds(params_.value("post_click_wait_ms", 500)));
 }
 
-bool HelloTask::step_shotAfter() {
+StepResult HelloTask::step_shotAfter() {
     const auto io_backend = IOBackend::from_string(params_.value("io_backend", std::string("window_message")));
     logger_->info(std::string("[Step] Capturing AFTER image with backend: ") + IOBackend::to_string(io_backend));
 
-    captured_after_ = Screenshot::capture_with_backend(io_backend);
+    captured_after_ = Screenshot::capture_bgra(io_backend);
     if (captured_after_.empty()) {
-        logger_->error("After image is empty.");
-        return false;
+        logger_->warn("After image is empty.");
+        return StepResult::retry();
     }
 
     preview_image_ = build_preview(captured_before_, captured_after_, click_rect_);
     if (preview_image_.empty()) {
         logger_->error("Failed to build the preview image.");
-        return false;
+        return StepResult::fail();
     }
-    return true;
+    return StepResult::next();
 }
 
 bool HelloTask::step_benchmarkCapture() {
@@ -196,13 +268,13 @@ bool HelloTask::step_benchmarkCapture() {
         double total_ms = 0.0;
 
         for (int i = 0; i < iterations; ++i) {
-            if (stop_requested_.load()) {
+            if (stopRequested()) {
                 break;
             }
 
             const auto started_at = std::chrono::steady_clock::now();
             try {
-                cv::Mat image = Screenshot::capture_with_backend(backend);
+                cv::Mat image = Screenshot::capture_bgra(backend);
                 if (!image.empty()) {
                     const auto elapsed = std::chrono::steady_clock::now() - started_at;
                     total_ms += std::chrono::duration<double, std::milli>(elapsed).count();
@@ -240,14 +312,26 @@ bool HelloTask::step_showImage() {
     }
 
     const std::string preview_window_name = params_.value("preview_window_name", std::string("Message Backend Test"));
-    logger_->info("[Step] Showing comparison image. Close the window or press any key to continue.");
+    logger_->info("[Step] Publishing comparison image to the preview channel.");
     if (!benchmark_summary_.empty()) {
         logger_->info("[Benchmark] " + benchmark_summary_);
     }
 
-    cv::namedWindow(preview_window_name, cv::WINDOW_AUTOSIZE);
-    cv::imshow(preview_window_name, preview_image_);
-    cv::waitKey(0);
+    if (!FramePreview::publish(preview_image_, preview_window_name, *logger_)) {
+        logger_->warn("[Step] No preview subscriber or preview channel unavailable, comparison image was not published.");
+    }
+
+    if (params_.value("debug_window", false)) {
+        logger_->info("[Step] Showing comparison image. Close the window or press any key to continue.");
+        cv::namedWindow(preview_window_name, cv::WINDOW_AUTOSIZE);
+        cv::imshow(preview_window_name, preview_image_);
+        // 轮询代替 waitKey(0)，任务停止时不会卡在窗口上
+        while (!stopRequested()) {
+            if (cv::waitKey(50) >= 0 || cv::getWindowProperty(preview_window_name, cv::WND_PROP_VISIBLE) < 1) {
+                break;
+            }
+        }
+    }
     return true;
 }
 
@@ -257,6 +341,8 @@ bool HelloTask::step_cleanup() {
     captured_after_.release();
     preview_image_.release();
     benchmark_summary_.clear();
-    cv::destroyAllWindows();
+    if (params_.value("debug_window", false)) {
+        cv::destroyAllWindows();
+    }
     return true;
 }
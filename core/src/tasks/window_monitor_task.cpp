@@ -0,0 +1,70 @@
+#include "tasks/window_monitor_task.h"
+
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "basic/exceptions.h"
+#include "basic/metrics.h"
+#include "io/window_handler.h"
+
+WindowMonitorTask::WindowMonitorTask(std::string name) : ThreadedTask(std::move(name)) {
+    registerStep(WATCH, std::bind(&WindowMonitorTask::step_watch, this));
+}
+
+bool WindowMonitorTask::step_watch() {
+    const int interval_ms = (std::max)(100, params_.value("interval_ms", 1000));
+
+    auto& metrics = Metrics::instance();
+    auto& found_gauge = metrics.gauge("window.found");
+    auto& minimized_gauge = metrics.gauge("window.minimized");
+    auto& foreground_gauge = metrics.gauge("window.foreground");
+    auto& width_gauge = metrics.gauge("window.client_width");
+    auto& height_gauge = metrics.gauge("window.client_height");
+
+    logger_->info("窗口监视开始。");
+    std::string last_state;
+    do {
+        std::string state;
+        HWND hwnd = NULL;
+        try {
+            hwnd = WindowHandler::find_game_window();
+        } catch (const WindowException&) {
+            hwnd = NULL;
+        }
+
+        if (hwnd && IsWindow(hwnd)) {
+            RECT rc = {0, 0, 0, 0};
+            GetClientRect(hwnd, &rc);
+            const int width = rc.right - rc.left;
+            const int height = rc.bottom - rc.top;
+            const bool minimized = IsIconic(hwnd) != FALSE;
+            const bool foreground = GetForegroundWindow() == hwnd;
+
+            found_gauge.set(1.0);
+            minimized_gauge.set(minimized ? 1.0 : 0.0);
+            foreground_gauge.set(foreground ? 1.0 : 0.0);
+            width_gauge.set(width);
+            height_gauge.set(height);
+
+            if (minimized) {
+                state = "已最小化";
+            } else {
+                state = std::to_string(width) + "x" + std::to_string(height) + (foreground ? "，前台" : "，后台");
+            }
+        } else {
+            found_gauge.set(0.0);
+            state = "未找到游戏窗口";
+        }
+
+        if (state != last_state) {
+            updateStatus("运行中：" + state);
+            logger_->info("游戏窗口状态：" + state);
+            last_state = std::move(state);
+        }
+    } while (sleepFor(std::chrono::milliseconds(interval_ms)));
+
+    logger_->info("窗口监视已停止。");
+    return true;
+}
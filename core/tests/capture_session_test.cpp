@@ -0,0 +1,181 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "io/capture_session.h"
+#include "io/frame_pool.h"
+#include "io/frame_source.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr int FRAME_COUNT = 24;
+
+using TestUtil::check;
+
+// 第 i 帧所有像素为 i，channels 为 3 或 4
+std::string write_dump(const std::string& name, int width, int height, int channels, int first_value = 0) {
+    const std::string path = TestUtil::temp_path(name);
+    RawFrameDumpWriter writer(path);
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        cv::Mat image(height, width, CV_8UC(channels));
+        std::memset(image.data, first_value + i, image.total() * image.elemSize());
+        writer.write(image, std::chrono::milliseconds(i * 10));
+    }
+    return path;
+}
+
+std::shared_ptr<IFrameSource> open_dump(const std::string& path) {
+    PlaybackOptions options;
+    options.pacing = PlaybackOptions::Pacing::Fastest;
+    return std::make_shared<RawDumpSource>(path, options);
+}
+
+bool filled_with(const cv::Mat& image, int value) {
+    if (image.empty() || image.type() != CV_8UC3) {
+        return false;
+    }
+    for (int y = 0; y < image.rows; ++y) {
+        const uchar* row = image.ptr(y);
+        for (int x = 0; x < image.cols * 3; ++x) {
+            if (row[x] != value) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 依次播放多个帧源，用于模拟窗口尺寸变化
+class ConcatSource : public IFrameSource {
+public:
+    explicit ConcatSource(std::vector<std::shared_ptr<IFrameSource>> parts) : parts_(std::move(parts)) {}
+
+    bool grab(SourceFrame& frame) override {
+        while (current_ < parts_.size()) {
+            if (parts_[current_]->grab(frame)) {
+                return true;
+            }
+            ++current_;
+        }
+        return false;
+    }
+    bool isLive() const override { return false; }
+    std::string describe() const override { return "concat"; }
+
+private:
+    std::vector<std::shared_ptr<IFrameSource>> parts_;
+    size_t current_ = 0;
+};
+
+// BGRA 转储就地转换进池中的缓冲区：稳定运行时既不分配也不拷贝
+void test_in_place_source(const std::string& bgra_dump) {
+    CaptureSession session(open_dump(bgra_dump));
+    bool pixels_ok = true;
+    int frames = 0;
+    while (FrameHandle frame = session.next()) {
+        pixels_ok = pixels_ok && filled_with(frame.image(), frames) && frame.index() == static_cast<uint64_t>(frames);
+        ++frames;
+    }
+    const CaptureSession::Stats stats = session.stats();
+    check(frames == FRAME_COUNT && pixels_ok, "BGRA 转储逐帧内容正确");
+    check(stats.reallocations == 1, "BGRA 转储只在第一帧分配缓冲区（实际 " + std::to_string(stats.reallocations) + " 次）");
+    check(stats.copies == 0, "BGRA 转储无需拷贝");
+    check(stats.pool.overflows == 0, "逐帧释放句柄时只使用池中的槽位");
+}
+
+// BGR 转储只提供映射内存的视图，拷贝进池中的缓冲区，同样不再分配
+void test_view_source(const std::string& bgr_dump) {
+    CaptureSession session(open_dump(bgr_dump));
+    int frames = 0;
+    bool pixels_ok = true;
+    while (FrameHandle frame = session.next()) {
+        pixels_ok = pixels_ok && filled_with(frame.image(), frames);
+        ++frames;
+    }
+    const CaptureSession::Stats stats = session.stats();
+    check(frames == FRAME_COUNT && pixels_ok, "BGR 转储逐帧内容正确");
+    check(stats.copies == static_cast<uint64_t>(FRAME_COUNT), "BGR 转储每帧拷贝一次");
+    check(stats.reallocations == 1, "BGR 转储只在第一帧分配缓冲区（实际 " + std::to_string(stats.reallocations) + " 次）");
+}
+
+// 持有的句柄不会被之后的帧改写；池满时临时分配，句柄可以比会话活得更久
+void test_held_handles(const std::string& bgra_dump) {
+    std::vector<FrameHandle> held;
+    {
+        CaptureSession session(open_dump(bgra_dump), 2);
+        for (int i = 0; i < 3; ++i) {
+            held.push_back(session.next());
+        }
+        FrameHandle shared = held[0];
+        check(shared.useCount() == 2, "拷贝句柄只增加引用计数");
+
+        for (int i = 3; i < 8; ++i) {
+            session.next();
+        }
+        // 两个槽位都被持有，第 3 帧起每帧都临时分配
+        const CaptureSession::Stats stats = session.stats();
+        check(stats.pool.overflows == 6, "池满时临时分配槽位（实际 " + std::to_string(stats.pool.overflows) + " 次）");
+    }
+    bool intact = true;
+    for (size_t i = 0; i < held.size(); ++i) {
+        intact = intact && filled_with(held[i].image(), static_cast<int>(i));
+    }
+    check(intact, "持有的句柄在会话销毁后内容不变");
+}
+
+// 像素拷贝进调用方的 Mat 后句柄即可释放，单个槽位也能逐帧复用，拷贝不受之后的帧影响
+void test_copied_out(const std::string& bgra_dump) {
+    CaptureSession session(open_dump(bgra_dump), 1);
+    cv::Mat first;
+    session.next().image().copyTo(first);
+    cv::Mat kept;
+    for (int i = 1; i < 4; ++i) {
+        session.next().image().copyTo(kept);
+    }
+    const CaptureSession::Stats stats = session.stats();
+    check(filled_with(first, 0) && filled_with(kept, 3), "拷贝出的画面不会被之后的帧改写");
+    check(stats.pool.overflows == 0, "释放句柄后槽位立即归还");
+    check(stats.reallocations == 1, "槽位的缓冲区只分配一次（实际 " + std::to_string(stats.reallocations) + " 次）");
+}
+
+// 画面尺寸变化时每个槽位各重新分配一次，之后恢复复用
+void test_size_change(const std::string& small_dump, const std::string& large_dump) {
+    CaptureSession session(std::make_shared<ConcatSource>(
+        std::vector<std::shared_ptr<IFrameSource>>{open_dump(small_dump), open_dump(large_dump)}), 2);
+    int frames = 0;
+    bool sizes_ok = true;
+    while (FrameHandle frame = session.next()) {
+        const cv::Size expected = frames < FRAME_COUNT ? cv::Size(64, 32) : cv::Size(80, 40);
+        sizes_ok = sizes_ok && frame.image().size() == expected;
+        ++frames;
+    }
+    const CaptureSession::Stats stats = session.stats();
+    check(frames == 2 * FRAME_COUNT && sizes_ok, "尺寸变化前后的帧尺寸正确");
+    check(stats.reallocations == 2, "尺寸变化只触发重新分配（实际 " + std::to_string(stats.reallocations) + " 次）");
+}
+
+} // namespace
+
+int main() {
+    const std::string bgra_dump = write_dump("bd2_capture_session_bgra.raw", 64, 32, 4);
+    const std::string bgr_dump = write_dump("bd2_capture_session_bgr.raw", 64, 32, 3);
+    const std::string large_dump = write_dump("bd2_capture_session_large.raw", 80, 40, 4);
+
+    test_in_place_source(bgra_dump);
+    test_view_source(bgr_dump);
+    test_held_handles(bgra_dump);
+    test_copied_out(bgra_dump);
+    test_size_change(bgra_dump, large_dump);
+
+    std::remove(bgra_dump.c_str());
+    std::remove(bgr_dump.c_str());
+    std::remove(large_dump.c_str());
+
+    return TestUtil::finish();
+}
@@ -0,0 +1,242 @@
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+#include <opencv2/core.hpp>
+
+#include "io/flight_recorder.h"
+#include "io/frame_source.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr int FRAME_COUNT = 60;
+constexpr int FRAME_INTERVAL_MS = 10;
+
+using TestUtil::check;
+using TestUtil::same_pixels;
+using TestUtil::temp_path;
+
+// 亮条随帧序号移动，模拟进度条中移动的指针
+cv::Mat make_frame(int index, int width, int height, int channels) {
+    return TestUtil::make_frame(width, height, channels, index % width);
+}
+
+// 两个画面流（BGRA 的进度条与 BGR 的扩展区域），每帧一条识别结果，每 5 帧一次按键
+std::string write_log(const std::string& name, FlightRecorder::Stats* stats = nullptr) {
+    const std::string path = temp_path(name);
+    FlightRecorder::Options options;
+    options.chunk_duration = std::chrono::milliseconds(100);
+    options.keyframe_interval = 16;
+    options.queue_capacity = 4 * FRAME_COUNT;
+    FlightRecorder recorder(path, options);
+    const auto start = FlightRecorder::Clock::now();
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        const auto at = start + std::chrono::milliseconds(i * FRAME_INTERVAL_MS);
+        recorder.recordFrame(make_frame(i, 120, 16, 4), 0, cv::Point(400, 900), at);
+        recorder.recordFrame(make_frame(i * 2, 90, 40, 3), 1, cv::Point(410, 880), at);
+        recorder.recordDetection({{"frame", i}, {"cur_x", i % 120}}, 0, at);
+        if (i % 5 == 0) {
+            recorder.recordInput({{"key", "space"}, {"frame", i}}, at);
+        }
+    }
+    recorder.close();
+    if (stats) {
+        *stats = recorder.stats();
+    }
+    return path;
+}
+
+void test_round_trip() {
+    FlightRecorder::Stats stats;
+    const std::string path = write_log("bd2_flight_round_trip.bin", &stats);
+    check(stats.dropped == 0 && stats.records == FRAME_COUNT * 3 + FRAME_COUNT / 5, "所有记录都被写入");
+    check(stats.chunks > 1, "按时间切分为多个分块");
+    check(stats.encoded_bytes * 4 < stats.raw_bytes, "局部变化的画面压缩到原大小的四分之一以下");
+
+    FlightLogReader reader(path);
+    check(reader.chunks().size() == stats.chunks, "读取方从分块头建立索引");
+
+    FlightRecord record;
+    int frames[2] = {0, 0};
+    int detections = 0;
+    int inputs = 0;
+    bool pixels_ok = true;
+    bool origin_ok = true;
+    std::chrono::microseconds first{-1};
+    while (reader.next(record)) {
+        if (first.count() < 0) {
+            first = record.timestamp;
+        }
+        if (record.type == FlightRecordType::Frame) {
+            const int index = frames[record.stream]++;
+            const cv::Mat expected = record.stream == 0 ? make_frame(index, 120, 16, 4) : make_frame(index * 2, 90, 40, 3);
+            pixels_ok = pixels_ok && same_pixels(record.image, expected);
+            origin_ok = origin_ok && record.origin == (record.stream == 0 ? cv::Point(400, 900) : cv::Point(410, 880));
+        } else if (record.type == FlightRecordType::Detection) {
+            ++detections;
+        } else if (record.type == FlightRecordType::Input) {
+            ++inputs;
+        }
+    }
+    check(frames[0] == FRAME_COUNT && frames[1] == FRAME_COUNT, "两个画面流的帧数完整");
+    check(pixels_ok, "关键帧与差分帧都无损还原");
+    check(origin_ok, "保留区域在客户区中的位置");
+    check(detections == FRAME_COUNT && inputs == FRAME_COUNT / 5, "识别结果与按键记录完整");
+    check(reader.endTime() - reader.startTime() == std::chrono::milliseconds((FRAME_COUNT - 1) * FRAME_INTERVAL_MS),
+        "时间范围与记录的时间戳一致");
+    std::filesystem::remove(path);
+}
+
+void test_seek() {
+    const std::string path = write_log("bd2_flight_seek.bin");
+    FlightLogReader reader(path);
+    const int target_frame = 37;  // 位于某个分块中间，之前的差分帧需要先解码
+    const auto target = reader.startTime() + std::chrono::milliseconds(target_frame * FRAME_INTERVAL_MS);
+    reader.seek(target);
+
+    FlightRecord record;
+    check(reader.next(record) && record.timestamp == target, "定位到不早于目标时间的第一条记录");
+    bool pixels_ok = record.type == FlightRecordType::Frame && same_pixels(record.image, make_frame(target_frame, 120, 16, 4));
+    check(pixels_ok, "定位后的第一帧正确解码");
+    check(reader.next(record) && record.stream == 1 && same_pixels(record.image, make_frame(target_frame * 2, 90, 40, 3)),
+        "定位后其他画面流同样可以解码");
+    check(reader.next(record) && record.type == FlightRecordType::Detection && record.data["frame"] == target_frame,
+        "定位后的识别结果与画面对应");
+
+    reader.seek(reader.endTime() + std::chrono::milliseconds(1));
+    check(!reader.next(record), "定位到末尾之后没有记录");
+    reader.rewind();
+    check(reader.next(record) && record.timestamp == reader.startTime(), "rewind 回到第一条记录");
+    std::filesystem::remove(path);
+}
+
+void test_truncated() {
+    const std::string path = write_log("bd2_flight_truncated.bin");
+    size_t full_chunks = 0;
+    {
+        FlightLogReader reader(path);
+        full_chunks = reader.chunks().size();
+    }
+    // 模拟写入最后一个分块时崩溃
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 10);
+    FlightLogReader reader(path);
+    check(reader.chunks().size() == full_chunks - 1, "不完整的最后一个分块被忽略");
+
+    FlightRecord record;
+    size_t records = 0;
+    while (reader.next(record)) {
+        ++records;
+    }
+    check(records > 0, "之前的分块仍然可读");
+    std::filesystem::remove(path);
+}
+
+void test_non_continuous() {
+    const std::string path = temp_path("bd2_flight_roi.bin");
+    const cv::Mat frame = make_frame(5, 200, 60, 3);
+    const cv::Rect roi(30, 10, 50, 20);
+    {
+        FlightRecorder recorder(path);
+        recorder.recordFrame(frame(roi), 0, roi.tl());
+    }
+    FlightLogReader reader(path);
+    FlightRecord record;
+    check(reader.next(record) && same_pixels(record.image, frame(roi).clone()) && record.origin == roi.tl(),
+        "不连续的 ROI 视图按行记录");
+    std::filesystem::remove(path);
+}
+
+void test_dropped() {
+    const std::string path = temp_path("bd2_flight_dropped.bin");
+    FlightRecorder::Options options;
+    options.queue_capacity = 1;
+    FlightRecorder recorder(path, options);
+    const cv::Mat frame = make_frame(0, 640, 360, 4);
+    int accepted = 0;
+    for (int i = 0; i < 200; ++i) {
+        accepted += recorder.recordFrame(frame, 0) ? 1 : 0;
+    }
+    recorder.close();
+    const auto stats = recorder.stats();
+    check(stats.records == static_cast<uint64_t>(accepted) && stats.records + stats.dropped == 200,
+        "队列已满时丢弃记录并计数，不阻塞调用方");
+    check(!recorder.recordEvent({{"event", "late"}}), "关闭后不再接受记录");
+    std::filesystem::remove(path);
+}
+
+void test_frame_source() {
+    const std::string path = write_log("bd2_flight_source.bin");
+    PlaybackOptions options;
+    options.pacing = PlaybackOptions::Pacing::Fastest;
+    options.loop = true;
+    FlightRecordSource source(path, options, 0);
+
+    SourceFrame frame;
+    bool ok = true;
+    for (int i = 0; i < FRAME_COUNT + 5; ++i) {
+        ok = ok && source.grab(frame) && frame.image.type() == CV_8UC3 && frame.image.cols == 120;
+    }
+    check(ok, "画面流作为 BGR 帧源循环回放");
+    check(frame.index == FRAME_COUNT + 4, "循环回放时帧序号继续递增");
+    std::filesystem::remove(path);
+}
+
+// 与钓鱼任务相同的录制方式：从整窗画面裁出进度条与扩展区域，以同一时间戳各记一个画面流。
+// 回放得到的每组区域应与从原画面按同样位置裁出的像素一致
+void test_region_replay() {
+    const std::string path = temp_path("bd2_flight_regions.bin");
+    const cv::Rect bar(252, 306, 161, 18);
+    const cv::Rect ext(252, 297, 161, 36);
+    constexpr int DROPPED = 7;  // 这一帧只记录了进度条，模拟记录时队列已满
+    {
+        FlightRecorder::Options options;
+        options.keyframe_interval = 16;
+        options.queue_capacity = 4 * FRAME_COUNT;
+        FlightRecorder recorder(path, options);
+        const auto start = FlightRecorder::Clock::now();
+        for (int i = 0; i < FRAME_COUNT; ++i) {
+            const auto at = start + std::chrono::milliseconds(i * FRAME_INTERVAL_MS);
+            const cv::Mat screen = make_frame(i * 3, 640, 360, 4);
+            recorder.recordFrame(screen(bar), 0, bar.tl(), at);
+            if (i != DROPPED) {
+                recorder.recordFrame(screen(ext), 1, ext.tl(), at);
+            }
+            recorder.recordDetection({{"frame", i}}, 0, at);
+        }
+        recorder.close();
+    }
+
+    FlightRegionReader reader(path, {0, 1});
+    FlightRegionReader::Regions regions;
+    int groups = 0;
+    bool same = true;
+    bool skipped = true;
+    while (reader.next(regions)) {
+        const auto index = static_cast<int>(regions.timestamp.count() / (FRAME_INTERVAL_MS * 1000));
+        skipped = skipped && index != DROPPED;
+        const cv::Mat screen = make_frame(index * 3, 640, 360, 4);
+        same = same && cv::Rect(regions.origins[0], regions.images[0].size()) == bar
+            && cv::Rect(regions.origins[1], regions.images[1].size()) == ext
+            && same_pixels(regions.images[0], screen(bar)) && same_pixels(regions.images[1], screen(ext));
+        ++groups;
+    }
+    check(groups == FRAME_COUNT - 1, "每个时刻读出一组区域");
+    check(same, "回放的区域与原画面按同样位置裁出的像素一致");
+    check(skipped, "缺少画面流的组被跳过");
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main() {
+    test_round_trip();
+    test_seek();
+    test_truncated();
+    test_non_continuous();
+    test_dropped();
+    test_frame_source();
+    test_region_replay();
+
+    return TestUtil::finish();
+}
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "basic/rpc_encoding.h"
+
+namespace {
+
+// 每种消息、每种编码的重复次数
+constexpr int ITERATIONS = 20000;
+
+struct BenchResult {
+    double encode_ms = 0.0;
+    double decode_ms = 0.0;
+    size_t bytes = 0;
+    bool roundtrip_ok = true;
+};
+
+// 构造与实际通道流量相近的几类消息：逐条日志、任务状态、帧元数据
+std::vector<json> build_sample_messages() {
+    std::vector<json> messages;
+
+    messages.push_back({
+        {"jsonrpc", "2.0"},
+        {"method", "log"},
+        {"params", {
+            {"level", "info"},
+            {"message", "【黄色命中】"},
+            {"payload", {{"type", "log"}, {"level", "info"}, {"message", "【黄色命中】"}}}
+        }}
+    });
+
+    messages.push_back({
+        {"jsonrpc", "2.0"},
+        {"id", 42},
+        {"result", {
+            {"active_task", {{"name", "fishing_task"}, {"status", "运行中：步骤 0"}, {"progress", 0}}},
+            {"message", "当前活动任务 'fishing_task' 的状态。"}
+        }}
+    });
+
+    messages.push_back({
+        {"jsonrpc", "2.0"},
+        {"method", "frame/preview"},
+        {"params", {
+            {"level", "info"},
+            {"message", ""},
+            {"payload", {
+                {"ring", "bd2_auto_preview"},
+                {"slot", 3},
+                {"sequence", 123456},
+                {"width", 600},
+                {"height", 36},
+                {"channels", 4},
+                {"timestamp_us", 9876543210LL}
+            }}
+        }}
+    });
+
+    return messages;
+}
+
+BenchResult run_bench(const std::vector<json>& messages, RpcEncoding::Mode mode) {
+    BenchResult result;
+    std::vector<std::string> encoded;
+    encoded.reserve(messages.size() * ITERATIONS);
+
+    const auto encode_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        for (const auto& message : messages) {
+            encoded.push_back(RpcEncoding::encode(message, mode));
+        }
+    }
+    const auto encode_end = std::chrono::steady_clock::now();
+
+    for (const auto& frame : encoded) {
+        result.bytes += frame.size();
+    }
+
+    size_t index = 0;
+    const auto decode_start = std::chrono::steady_clock::now();
+    for (const auto& frame : encoded) {
+        const json decoded = RpcEncoding::decode_message(frame, mode);
+        if (decoded != messages[index % messages.size()]) {
+            result.roundtrip_ok = false;
+        }
+        ++index;
+    }
+    const auto decode_end = std::chrono::steady_clock::now();
+
+    result.encode_ms = std::chrono::duration<double, std::milli>(encode_end - encode_start).count();
+    result.decode_ms = std::chrono::duration<double, std::milli>(decode_end - decode_start).count();
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<json> messages = build_sample_messages();
+    const double total_messages = static_cast<double>(messages.size()) * ITERATIONS;
+
+    std::cout << "消息数量: " << static_cast<long long>(total_messages) << std::endl;
+    std::cout << std::left << std::setw(10) << "编码"
+              << std::right << std::setw(14) << "编码 msg/s"
+              << std::setw(14) << "解码 msg/s"
+              << std::setw(14) << "平均字节" << std::endl;
+
+    bool all_ok = true;
+    for (const auto mode : {RpcEncoding::Mode::Text, RpcEncoding::Mode::Cbor, RpcEncoding::Mode::MsgPack}) {
+        const BenchResult result = run_bench(messages, mode);
+        all_ok = all_ok && result.roundtrip_ok;
+
+        std::cout << std::left << std::setw(10) << RpcEncoding::to_string(mode)
+                  << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << total_messages / (result.encode_ms / 1000.0)
+                  << std::setw(14) << total_messages / (result.decode_ms / 1000.0)
+                  << std::setprecision(1)
+                  << std::setw(14) << static_cast<double>(result.bytes) / total_messages
+                  << (result.roundtrip_ok ? "" : "  往返校验失败!") << std::endl;
+    }
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include <optional>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "automator/screen_context.h"
+#include "test_util.h"
+
+namespace {
+
+using TestUtil::check;
+
+constexpr int WIDTH = 200;
+constexpr int HEIGHT = 120;
+constexpr int TILE_SIZE = 32;
+
+const UILayouts::Metadata LAYOUT{"menu", "menu.png", cv::Rect(10, 10, 40, 20)};
+const UITemplates::Metadata TEMPLATE{"button", "button.png"};
+const cv::Size TEMPLATE_SIZE(20, 10);
+
+// 记录每次匹配调用的伪匹配器，匹配结果由测试指定；find 只返回落在搜索区域内的位置
+struct FakeMatcher {
+    int verify_calls = 0;
+    bool verify_result = true;
+    std::vector<cv::Rect> searches;
+    std::optional<cv::Rect> target;
+
+    UIAutomator::ScreenContext::Matcher bind() {
+        return {
+            [this](const cv::Mat&, const UILayouts::Metadata&, double) {
+                ++verify_calls;
+                return verify_result;
+            },
+            [this](const cv::Mat&, const cv::Rect& search, const UITemplates::Metadata&, double) {
+                searches.push_back(search);
+                return target && (*target & search) == *target ? target : std::nullopt;
+            },
+            [](const UITemplates::Metadata&) { return TEMPLATE_SIZE; },
+        };
+    }
+};
+
+void touch(cv::Mat& frame, int x, int y) {
+    frame.ptr(y)[x * frame.channels()] ^= 0x80;
+}
+
+void test_verify_reuse() {
+    FakeMatcher matcher;
+    UIAutomator::ScreenContext context(matcher.bind(), TILE_SIZE);
+    cv::Mat frame = TestUtil::make_frame(WIDTH, HEIGHT, 3);
+
+    context.update(frame);
+    check(context.verify(LAYOUT) && matcher.verify_calls == 1, "第一帧执行匹配");
+
+    context.update(frame.clone());
+    check(context.verify(LAYOUT) && matcher.verify_calls == 1, "静止画面复用上次的结果");
+
+    touch(frame, 150, 100);
+    context.update(frame);
+    check(context.verify(LAYOUT) && matcher.verify_calls == 1, "布局区域之外的变化不触发匹配");
+
+    matcher.verify_result = false;
+    touch(frame, 20, 15);
+    context.update(frame);
+    check(!context.verify(LAYOUT) && matcher.verify_calls == 2, "布局区域变化后重新匹配");
+    check(!context.verify(LAYOUT) && matcher.verify_calls == 2, "未命中的结果同样被复用");
+    context.verify(LAYOUT, 0.8);
+    check(matcher.verify_calls == 3, "置信度不同时不复用");
+}
+
+void test_find_hit_reuse() {
+    FakeMatcher matcher;
+    matcher.target = cv::Rect(100, 50, TEMPLATE_SIZE.width, TEMPLATE_SIZE.height);
+    UIAutomator::ScreenContext context(matcher.bind(), TILE_SIZE);
+    cv::Mat frame = TestUtil::make_frame(WIDTH, HEIGHT, 3);
+    const cv::Rect full(0, 0, WIDTH, HEIGHT);
+
+    context.update(frame);
+    check(context.find(TEMPLATE) == matcher.target && matcher.searches.size() == 1 && matcher.searches[0] == full,
+        "第一帧搜索整个画面");
+
+    context.update(frame.clone());
+    check(context.find(TEMPLATE) == matcher.target && matcher.searches.size() == 1, "命中位置未变化时沿用");
+
+    touch(frame, 10, 100);
+    context.update(frame);
+    check(context.find(TEMPLATE) == matcher.target && matcher.searches.size() == 1, "其他区域的变化不触发搜索");
+
+    touch(frame, 105, 55);
+    context.update(frame);
+    context.find(TEMPLATE);
+    check(matcher.searches.size() == 2 && matcher.searches[1] == full, "命中位置变化后重新搜索整个画面");
+}
+
+void test_find_dirty_bounds() {
+    FakeMatcher matcher;
+    UIAutomator::ScreenContext context(matcher.bind(), TILE_SIZE);
+    cv::Mat frame = TestUtil::make_frame(WIDTH, HEIGHT, 3);
+
+    context.update(frame);
+    check(!context.find(TEMPLATE) && matcher.searches.size() == 1, "第一帧未命中");
+
+    context.update(frame.clone());
+    check(!context.find(TEMPLATE) && matcher.searches.size() == 1, "静止画面不再搜索");
+
+    // 像素 (70, 40) 位于分块 (64, 32, 32, 32)，搜索窗口向左上扩展模板尺寸减一
+    touch(frame, 70, 40);
+    context.update(frame);
+    matcher.target = cv::Rect(60, 30, TEMPLATE_SIZE.width, TEMPLATE_SIZE.height);
+    const std::optional<cv::Rect> found = context.find(TEMPLATE);
+    const cv::Rect expected(64 - TEMPLATE_SIZE.width + 1, 32 - TEMPLATE_SIZE.height + 1,
+        TILE_SIZE + 2 * (TEMPLATE_SIZE.width - 1), TILE_SIZE + 2 * (TEMPLATE_SIZE.height - 1));
+    check(matcher.searches.size() == 2 && matcher.searches[1] == expected, "只搜索变化分块附近的区域");
+    check(found == matcher.target, "变化区域中出现的模板可以找到");
+
+    // 模板消失后重新搜索整个画面；之后跨越多帧的变化合并为一个外接矩形
+    matcher.target.reset();
+    touch(frame, 65, 35);
+    context.update(frame);
+    check(!context.find(TEMPLATE) && matcher.searches.size() == 3, "命中位置变化后重新搜索");
+    touch(frame, 40, 100);
+    context.update(frame);
+    touch(frame, 150, 10);
+    context.update(frame);
+    context.find(TEMPLATE);
+    // 变化的分块为 (32, 96) 与 (128, 0)，外接矩形 (32, 0, 128, 120) 扩展后裁剪到画面内
+    check(matcher.searches.size() == 4 && matcher.searches[3] == cv::Rect(13, 0, 166, HEIGHT),
+        "跨越多帧的变化取外接矩形，裁剪到画面内");
+}
+
+} // namespace
+
+int main() {
+    test_verify_reuse();
+    test_find_hit_reuse();
+    test_find_dirty_bounds();
+
+    return TestUtil::finish();
+}
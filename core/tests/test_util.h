@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 测试程序共用的断言与测试图像。
+ *
+ * 每个测试程序是一个普通的 main：逐项调用 check 打印结果，最后 return finish()，
+ * 由 CTest 按退出码判断成败。
+ */
+namespace TestUtil {
+
+inline bool all_ok = true;
+
+inline void check(bool condition, const std::string& what) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << what << std::endl;
+    all_ok = all_ok && condition;
+}
+
+/**
+ * @brief 打印汇总，返回 main 的退出码。
+ */
+inline int finish() {
+    std::cout << (all_ok ? "全部通过" : "存在失败") << std::endl;
+    return all_ok ? 0 : 1;
+}
+
+inline std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/**
+ * @brief 平滑渐变的 8 位测试图像。marker 不为 -1 时在该列起画一条 3 像素宽的亮条，
+ * 模拟进度条中移动的指针；宽高可以不是分块大小的整数倍。
+ */
+inline cv::Mat make_frame(int width, int height, int channels, int marker = -1) {
+    cv::Mat image(height, width, CV_8UC(channels));
+    for (int y = 0; y < height; ++y) {
+        uchar* row = image.ptr(y);
+        for (int x = 0; x < width; ++x) {
+            const bool in_marker = marker >= 0 && x >= marker && x < marker + 3;
+            for (int c = 0; c < channels; ++c) {
+                row[x * channels + c] = in_marker ? 250 : static_cast<uchar>(x + y * 2 + c * 40);
+            }
+        }
+    }
+    return image;
+}
+
+inline bool same_pixels(const cv::Mat& a, const cv::Mat& b) {
+    if (a.rows != b.rows || a.cols != b.cols || a.type() != b.type()) {
+        return false;
+    }
+    for (int y = 0; y < a.rows; ++y) {
+        if (std::memcmp(a.ptr(y), b.ptr(y), static_cast<size_t>(a.cols) * a.elemSize()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace TestUtil
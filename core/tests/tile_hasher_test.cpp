@@ -0,0 +1,101 @@
+#include <opencv2/core.hpp>
+
+#include "cv/tile_hasher.h"
+#include "test_util.h"
+
+namespace {
+
+using TestUtil::check;
+
+// 宽高都不是分块大小的整数倍，覆盖边缘分块与行尾不足一个块的字节
+cv::Mat make_frame(int width = 100, int height = 70) {
+    return TestUtil::make_frame(width, height, 3);
+}
+
+void test_static_frames() {
+    TileHasher tiles(32);
+    cv::Mat frame = make_frame();
+    tiles.update(frame);
+    check(tiles.cols() == 4 && tiles.rows() == 3, "分块数向上取整");
+    check(tiles.changedCount() == 12, "第一帧所有分块都视为变化");
+
+    tiles.update(frame.clone());
+    check(tiles.changedCount() == 0, "内容相同的帧没有变化的分块");
+    check(tiles.changedRegions().empty(), "没有变化时不报告区域");
+}
+
+void test_single_pixel() {
+    TileHasher tiles(32);
+    cv::Mat frame = make_frame();
+    tiles.update(frame);
+    const uint64_t before = tiles.update(frame);
+
+    frame.ptr(40)[70 * 3 + 1] ^= 1;  // 像素 (70, 40)，位于分块 (2, 1)
+    tiles.update(frame);
+    check(tiles.changedCount() == 1 && tiles.changed(2, 1), "单个像素的变化只影响所在分块");
+    const auto regions = tiles.changedRegions();
+    check(regions.size() == 1 && regions[0] == cv::Rect(64, 32, 32, 32), "报告变化分块的像素区域");
+    check(tiles.changedSince(cv::Rect(60, 30, 20, 20), before), "覆盖变化分块的区域视为变化");
+    check(!tiles.changedSince(cv::Rect(0, 0, 60, 30), before), "其他区域保持不变");
+
+    // 最右侧的分块只有 4 像素宽，其中的变化同样可以检测到
+    frame.ptr(69)[99 * 3] ^= 0x80;
+    tiles.update(frame);
+    check(tiles.changedCount() == 1 && tiles.changed(3, 2), "边缘不完整的分块同样可以检测变化");
+}
+
+void test_changed_since() {
+    TileHasher tiles(32);
+    cv::Mat frame = make_frame();
+    tiles.update(frame);
+    const uint64_t checked_at = tiles.update(frame);
+
+    // 之后几帧只有左上角变化，右下角的判断结果可以一直复用
+    for (int i = 0; i < 3; ++i) {
+        frame.ptr(0)[i] ^= 0xFF;
+        tiles.update(frame);
+    }
+    check(!tiles.changedSince(cv::Rect(64, 32, 36, 38), checked_at), "多帧之后未变化的区域仍可复用");
+    check(tiles.changedSince(cv::Rect(0, 0, 10, 10), checked_at), "中间任一帧变化过的区域视为变化");
+    check(tiles.changedBoundsSince(checked_at) == cv::Rect(0, 0, 32, 32), "变化区域的外接矩形");
+    check(tiles.changedSince(cv::Rect(64, 32, 36, 38), 0), "帧序号 0 总是视为变化");
+    check(tiles.changedSince(cv::Rect(90, 60, 20, 20), tiles.frame()), "超出画面的区域视为变化");
+}
+
+void test_size_change() {
+    TileHasher tiles(32);
+    tiles.update(make_frame());
+    const uint64_t before = tiles.update(make_frame());
+    tiles.update(make_frame(64, 64));
+    check(tiles.cols() == 2 && tiles.rows() == 2 && tiles.changedCount() == 4, "尺寸变化后所有分块视为变化");
+    check(tiles.changedSince(cv::Rect(0, 0, 8, 8), before), "尺寸变化前的结果不可复用");
+}
+
+void test_roi_view() {
+    // 不连续的 ROI 视图按行读取，与拷贝出来的连续图像结果相同
+    cv::Mat frame = make_frame(200, 100);
+    const cv::Mat view = frame(cv::Rect(50, 10, 100, 70));
+    TileHasher view_tiles(32);
+    TileHasher copy_tiles(32);
+    view_tiles.update(view);
+    copy_tiles.update(view.clone());
+    view_tiles.update(view);
+    copy_tiles.update(view.clone());
+    check(view_tiles.changedCount() == 0 && copy_tiles.changedCount() == 0, "ROI 视图与连续图像都没有变化");
+
+    frame.ptr(10)[150 * 3] ^= 1;  // 视图之外的像素
+    view_tiles.update(view);
+    check(view_tiles.changedCount() == 0, "视图之外的变化不影响结果");
+}
+
+} // namespace
+
+int main() {
+    test_static_frames();
+    test_single_pixel();
+    test_changed_since();
+    test_size_change();
+    test_roi_view();
+
+    return TestUtil::finish();
+}
@@ -1,3 +1,5 @@
+mod preview;
+
 use std::sync::{Arc, Mutex};
 use tauri_plugin_shell::{process::CommandChild, ShellExt};
 use tauri_plugin_shell::process::CommandEvent;
@@ -148,6 +150,7 @@ pub fn run() {
         .plugin(tauri_plugin_opener::init())
         .plugin(tauri_plugin_shell::init())
         .manage(ProcessState::default())
+        .manage(preview::PreviewState::default())
         .setup(|app| {
             // 在应用启动时自动启动 core
             let handle = app.app_handle().clone();
@@ -161,7 +164,7 @@ pub fn run() {
             })?;
             Ok(())
         })
-        .invoke_handler(tauri::generate_handler![core_start, core_input])
+        .invoke_handler(tauri::generate_handler![core_start, core_input, preview::preview_read])
         .run(tauri::generate_context!())
         .expect("运行 Tauri 应用时出错");
 }
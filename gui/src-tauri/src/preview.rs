@@ -0,0 +1,183 @@
+// 读取 core 写入共享内存的预览帧（布局见 core/include/io/frame_ring.h）。
+// core 每发布一帧就推送一条 frame/preview 通知，前端据此调用 preview_read 取回像素。
+use std::sync::atomic::{fence, Ordering};
+use std::sync::Mutex;
+
+use serde::Deserialize;
+use tauri::ipc::Response;
+
+const SLOT_HEADER_SIZE: usize = 64;
+
+// frame/preview 通知的参数
+#[derive(Deserialize)]
+pub struct PreviewFrame {
+    ring: String,
+    ring_size: usize,
+    offset: usize,
+    sequence: u64,
+    width: usize,
+    height: usize,
+    channels: usize,
+    stride: usize,
+}
+
+#[derive(Default)]
+pub struct PreviewState(Mutex<Option<shm::Mapping>>);
+
+// 按序列锁读取一帧并转换为 RGBA：拷贝前后槽位的序号都等于通知中的序号时数据才完整，
+// 否则说明 core 已经覆盖了该槽位，前端丢弃这一帧等待下一条通知
+#[tauri::command]
+pub fn preview_read(frame: PreviewFrame, state: tauri::State<'_, PreviewState>) -> Result<Response, String> {
+    if frame.width == 0 || frame.height == 0 || !(frame.channels == 1 || frame.channels == 3 || frame.channels == 4) {
+        return Err("预览帧格式不受支持".to_string());
+    }
+    let pixel_bytes = frame.stride * frame.height;
+    if frame.offset < SLOT_HEADER_SIZE || frame.offset + pixel_bytes > frame.ring_size {
+        return Err("预览帧超出共享内存范围".to_string());
+    }
+
+    let mut guard = state.inner().0.lock().unwrap();
+    let reopen = match guard.as_ref() {
+        Some(mapping) => !mapping.matches(&frame.ring, frame.ring_size),
+        None => true,
+    };
+    if reopen {
+        *guard = None;
+        *guard = Some(shm::Mapping::open(&frame.ring, frame.ring_size)?);
+    }
+    let mapping = guard.as_ref().unwrap();
+
+    let sequence_at = frame.offset - SLOT_HEADER_SIZE;
+    if mapping.sequence(sequence_at)? != frame.sequence {
+        return Err("预览帧已被覆盖".to_string());
+    }
+    let mut pixels = vec![0u8; pixel_bytes];
+    mapping.read(frame.offset, &mut pixels)?;
+    fence(Ordering::Acquire);
+    if mapping.sequence(sequence_at)? != frame.sequence {
+        return Err("预览帧已被覆盖".to_string());
+    }
+
+    let mut rgba = Vec::with_capacity(frame.width * frame.height * 4);
+    for row in pixels.chunks_exact(frame.stride) {
+        for px in row[..frame.width * frame.channels].chunks_exact(frame.channels) {
+            match frame.channels {
+                1 => rgba.extend_from_slice(&[px[0], px[0], px[0], 255]),
+                _ => rgba.extend_from_slice(&[px[2], px[1], px[0], 255]),
+            }
+        }
+    }
+    Ok(Response::new(rgba))
+}
+
+#[cfg(windows)]
+mod shm {
+    use std::ffi::{c_void, CString};
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    const FILE_MAP_READ: u32 = 0x0004;
+
+    #[link(name = "kernel32")]
+    extern "system" {
+        fn OpenFileMappingA(desired_access: u32, inherit_handle: i32, name: *const i8) -> *mut c_void;
+        fn MapViewOfFile(mapping: *mut c_void, desired_access: u32, offset_high: u32, offset_low: u32, bytes: usize) -> *mut c_void;
+        fn UnmapViewOfFile(base: *const c_void) -> i32;
+        fn CloseHandle(handle: *mut c_void) -> i32;
+    }
+
+    // core 以 Local\<ring> 创建页面文件支持的映射，这里只读打开同一映射
+    pub struct Mapping {
+        name: String,
+        size: usize,
+        handle: *mut c_void,
+        base: *const u8,
+    }
+
+    // 映射只读且在 PreviewState 的互斥锁内访问
+    unsafe impl Send for Mapping {}
+
+    impl Mapping {
+        pub fn open(name: &str, size: usize) -> Result<Self, String> {
+            let mapping_name = CString::new(format!("Local\\{}", name)).map_err(|e| e.to_string())?;
+            unsafe {
+                let handle = OpenFileMappingA(FILE_MAP_READ, 0, mapping_name.as_ptr());
+                if handle.is_null() {
+                    return Err(format!("打开预览共享内存失败：{}", name));
+                }
+                let base = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, size);
+                if base.is_null() {
+                    CloseHandle(handle);
+                    return Err(format!("映射预览共享内存失败：{}", name));
+                }
+                Ok(Mapping { name: name.to_string(), size, handle, base: base as *const u8 })
+            }
+        }
+
+        pub fn matches(&self, name: &str, size: usize) -> bool {
+            self.name == name && self.size == size
+        }
+
+        pub fn sequence(&self, at: usize) -> Result<u64, String> {
+            if at + 8 > self.size {
+                return Err("预览帧超出共享内存范围".to_string());
+            }
+            let sequence = unsafe { &*(self.base.add(at) as *const AtomicU64) };
+            Ok(sequence.load(Ordering::Acquire))
+        }
+
+        pub fn read(&self, at: usize, out: &mut [u8]) -> Result<(), String> {
+            if at + out.len() > self.size {
+                return Err("预览帧超出共享内存范围".to_string());
+            }
+            unsafe { std::ptr::copy_nonoverlapping(self.base.add(at), out.as_mut_ptr(), out.len()) };
+            Ok(())
+        }
+    }
+
+    impl Drop for Mapping {
+        fn drop(&mut self) {
+            unsafe {
+                UnmapViewOfFile(self.base as *const c_void);
+                CloseHandle(self.handle);
+            }
+        }
+    }
+}
+
+#[cfg(not(windows))]
+mod shm {
+    use std::fs::File;
+    use std::os::unix::fs::FileExt;
+
+    // POSIX shm 对应 /dev/shm 下的文件，按偏移读取即可，不需要映射
+    pub struct Mapping {
+        name: String,
+        size: usize,
+        file: File,
+    }
+
+    impl Mapping {
+        pub fn open(name: &str, size: usize) -> Result<Self, String> {
+            let file = File::open(format!("/dev/shm/{}", name))
+                .map_err(|e| format!("打开预览共享内存失败：{}：{}", name, e))?;
+            Ok(Mapping { name: name.to_string(), size, file })
+        }
+
+        pub fn matches(&self, name: &str, size: usize) -> bool {
+            self.name == name && self.size == size
+        }
+
+        pub fn sequence(&self, at: usize) -> Result<u64, String> {
+            let mut bytes = [0u8; 8];
+            self.read(at, &mut bytes)?;
+            Ok(u64::from_ne_bytes(bytes))
+        }
+
+        pub fn read(&self, at: usize, out: &mut [u8]) -> Result<(), String> {
+            if at + out.len() > self.size {
+                return Err("预览帧超出共享内存范围".to_string());
+            }
+            self.file.read_exact_at(out, at as u64).map_err(|e| e.to_string())
+        }
+    }
+}
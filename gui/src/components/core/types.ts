@@ -15,6 +15,8 @@ export type TaskMeta = {
     must_last?: boolean
     is_looping?: boolean
   }
+  // 运行期间占用的资源：input / foreground 独占，capture 可共享
+  resources?: string[]
 }
 
 export type StatusSummary = {
@@ -46,6 +48,27 @@ export type FishingConfig = {
   freezeIntervalMs: number
 }
 
+// frame/preview 通知指向的共享内存槽位，由 preview_read 读取
+export type PreviewFrame = {
+  source: string
+  ring: string
+  ring_size: number
+  slot: number
+  offset: number
+  sequence: number
+  width: number
+  height: number
+  channels: number
+  stride: number
+}
+
+export type PreviewImage = {
+  source: string
+  width: number
+  height: number
+  pixels: Uint8ClampedArray
+}
+
 export type HelloConfig = {
   resetWindow: boolean
   windowWidth: number